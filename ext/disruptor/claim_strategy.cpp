@@ -8,8 +8,8 @@ ClaimStrategyInterface* CreateClaimStrategy(ClaimStrategyOption option,
     switch (option) {
         case kSingleThreadedStrategy:
             return new SingleThreadedStrategy(buffer_size);
-        // case kMultiThreadedStrategy:
-        //     return new MultiThreadedStrategy(buffer_size);
+        case kMultiThreadedStrategy:
+            return new MultiThreadedStrategy(buffer_size);
         default:
             return NULL;
     }
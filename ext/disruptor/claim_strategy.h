@@ -26,6 +26,7 @@
 #ifndef DISRUPTOR_CLAIM_STRATEGY_H_ // NOLINT
 #define DISRUPTOR_CLAIM_STRATEGY_H_ // NOLINT
 
+#include <cstdint>
 #include <thread>
 #include <vector>
 
@@ -106,114 +107,94 @@ class SingleThreadedStrategy :  public ClaimStrategyInterface {
 
 // Strategy to be used when there are multiple publisher threads claiming
 // {@link AbstractEvent}s.
-/*
+//
+// Sequences are claimed with an atomic increment. Publication is serialised
+// in claim order: a publisher waits until all earlier claims have been
+// published, such that the cursor always marks a contiguous range of
+// published events.
 class MultiThreadedStrategy :  public ClaimStrategyInterface {
  public:
     MultiThreadedStrategy(const int& buffer_size) :
         buffer_size_(buffer_size),
         sequence_(kInitialCursorValue),
-        min_processor_sequence_(kInitialCursorValue) {}
+        min_gating_sequence_(kInitialCursorValue) {}
 
     virtual int64_t IncrementAndGet(
             const std::vector<Sequence*>& dependent_sequences) {
-        WaitForCapacity(dependent_sequences, min_gating_sequence_local_);
-        int64_t next_sequence = sequence_.IncrementAndGet();
-        WaitForFreeSlotAt(next_sequence,
-                          dependent_sequences,
-                          min_gating_sequence_local_);
+        int64_t next_sequence = sequence_.IncrementAndGet(1L);
+        WaitForFreeSlotAt(next_sequence, dependent_sequences);
         return next_sequence;
     }
 
     virtual int64_t IncrementAndGet(const int& delta,
             const std::vector<Sequence*>& dependent_sequences) {
         int64_t next_sequence = sequence_.IncrementAndGet(delta);
-        WaitForFreeSlotAt(next_sequence,
-                          dependent_sequences,
-                          min_gating_sequence_local_);
+        WaitForFreeSlotAt(next_sequence, dependent_sequences);
         return next_sequence;
     }
-    virtual void SetSequence(const int64_t& sequence,
-            const std::vector<Sequence*>& dependent_sequences) {
-        sequence_.set_sequence(sequence);
-        WaitForFreeSlotAt(sequence,
-                          dependent_sequences,
-                          min_gating_sequence_local_);
-    }
 
     virtual bool HasAvalaibleCapacity(
             const std::vector<Sequence*>& dependent_sequences) {
         const int64_t wrap_point = sequence_.sequence() + 1L - buffer_size_;
-        if (wrap_point > min_gating_sequence_local_.sequence()) {
+        if (wrap_point > min_gating_sequence_.sequence()) {
             int64_t min_sequence = GetMinimumSequence(dependent_sequences);
-            min_gating_sequence_local_.set_sequence(min_sequence);
+            min_gating_sequence_.set_sequence(min_sequence);
             if (wrap_point > min_sequence)
                 return false;
         }
         return true;
     }
 
-    virtual void SerialisePublishing(const Sequence& cursor,
-                                     const int64_t& sequence,
-                                     const int64_t& batch_size) {
-        int64_t expected_sequence = sequence - batch_size;
-        int counter = retries;
+    // Only safe when no other publisher is claiming.
+    virtual void SetSequence(const int64_t& sequence,
+            const std::vector<Sequence*>& dependent_sequences) {
+        sequence_.set_sequence(sequence);
+        WaitForFreeSlotAt(sequence, dependent_sequences);
+    }
 
-        while (expected_sequence != cursor.sequence()) {
+    virtual void SerialisePublishing(const int64_t& sequence,
+                                     const Sequence& cursor,
+                                     const int64_t& batch_size) {
+        const int64_t expected_sequence = sequence - batch_size;
+        int counter = kRetries;
+        int64_t current;
+        // a cursor that was forced to the maximum value (i.e. closed) will
+        // not advance anymore
+        while ((current = cursor.sequence()) != expected_sequence &&
+               current != INT64_MAX) {
             if (0 == --counter) {
-                counter = retries;
+                counter = kRetries;
                 std::this_thread::yield();
             }
         }
     }
 
  private:
-    // Methods
-    void WaitForCapacity(const std::vector<Sequence*>& dependent_sequences,
-                         const MutableLong& min_gating_sequence) {
-        const int64_t wrap_point = sequence_.sequence() + 1L - buffer_size_;
-        if (wrap_point > min_gating_sequence.sequence()) {
-            int counter = retries;
-            int64_t min_sequence;
-            while (wrap_point > (min_sequence = GetMinimumSequence(dependent_sequences))) {
-                counter = ApplyBackPressure(counter);
-            }
-            min_gating_sequence.set_sequence(min_sequence);
-        }
-    }
+    MultiThreadedStrategy();
 
+    // The cached minimum gating sequence is shared by all publishers. Any
+    // value that was stored is a lower bound of the current minimum, since
+    // gating sequences only advance.
     void WaitForFreeSlotAt(const int64_t& sequence,
-                           const std::vector<Sequence*>& dependent_sequences,
-                           const MutableLong& min_gating_sequence) {
+            const std::vector<Sequence*>& dependent_sequences) {
         const int64_t wrap_point = sequence - buffer_size_;
-        if (wrap_point > min_gating_sequence.sequence()) {
+        if (wrap_point > min_gating_sequence_.sequence()) {
             int64_t min_sequence;
             while (wrap_point > (min_sequence = GetMinimumSequence(dependent_sequences))) {
                 std::this_thread::yield();
             }
-            min_gating_sequence.set_sequence(min_sequence);
+            min_gating_sequence_.set_sequence(min_sequence);
         }
     }
 
-    int ApplyBackPressure(int counter) {
-        if (0 != counter) {
-            --counter;
-            std::this_thread::yield();
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
-
-        return counter;
-    }
+    static const int kRetries = 100;
 
     const int buffer_size_;
     PaddedSequence sequence_;
-    thread_local PaddedLong min_gating_sequence_local_;
-
-    const int retries = 100;
+    PaddedSequence min_gating_sequence_;
 
     DISALLOW_COPY_AND_ASSIGN(MultiThreadedStrategy);
 };
-*/
 
 ClaimStrategyInterface* CreateClaimStrategy(ClaimStrategyOption option,
                                             const int& buffer_size);
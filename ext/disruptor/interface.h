@@ -138,6 +138,9 @@ template<typename T>
 class EventFactoryInterface {
  public:
      virtual T* NewInstance(const int& size) const = 0;
+     virtual void DeleteInstance(T* events, const int& size) const {
+         delete[] events;
+     }
 };
 
 // Callback interface to be implemented for processing events as they become
@@ -269,6 +272,11 @@ class WaitStrategyInterface {
 
     // Signal those waiting that the cursor has advanced.
     virtual void SignalAllWhenBlocking() = 0;
+
+    // Same as SignalAllWhenBlocking, for callers that already issued a
+    // sequentially consistent fence after advancing the cursor (e.g. after
+    // publishing on several sequencers at once).
+    virtual void SignalAllAfterFence() { SignalAllWhenBlocking(); }
 };
 
 };  // namespace disruptor
@@ -55,20 +55,26 @@ class RingBuffer : public Sequencer {
     // entries in the ring.
     // @param wait_strategy_option waiting strategy employed by
     // processors_to_track waiting in entries becoming available.
+    // @param wait_parameters tunable parameters of the wait strategy.
     RingBuffer(EventFactoryInterface<T>* event_factory,
                int buffer_size,
                ClaimStrategyOption claim_strategy_option,
-               WaitStrategyOption wait_strategy_option) :
+               WaitStrategyOption wait_strategy_option,
+               const WaitStrategyParameters& wait_parameters =
+                 WaitStrategyParameters()) :
             Sequencer(buffer_size,
                       claim_strategy_option,
-                      wait_strategy_option),
+                      wait_strategy_option,
+                      wait_parameters),
             buffer_size_(buffer_size),
             mask_(buffer_size - 1),
+            event_factory_(event_factory),
             events_(event_factory->NewInstance(buffer_size)) {
     }
 
+    // The event factory should outlive the ring buffer.
     ~RingBuffer() {
-        delete[] events_;
+        event_factory_->DeleteInstance(events_, buffer_size_);
     }
 
     // Get the event for a given sequence in the RingBuffer.
@@ -83,6 +89,7 @@ class RingBuffer : public Sequencer {
     // Members
     int buffer_size_;
     int mask_;
+    EventFactoryInterface<T>* event_factory_;
     T* events_;
 
     DISALLOW_COPY_AND_ASSIGN(RingBuffer);
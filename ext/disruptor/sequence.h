@@ -71,6 +71,25 @@ class Sequence {
         return value_.fetch_add(increment, std::memory_order::memory_order_release) + increment;
     }
 
+    // Set the value of the {@link Sequence} if it equals the expected value.
+    //
+    // @return true if the value was set.
+    bool CompareAndSet(int64_t expected, int64_t value) {
+        return value_.compare_exchange_strong(expected, value,
+            std::memory_order::memory_order_acq_rel);
+    }
+
+    // Address of the least significant 32 bit half of the counter. This
+    // word changes whenever the sequence advances, such that it can be used
+    // as a futex word to sleep on.
+    const void* futex_word() const {
+        const char* word = reinterpret_cast<const char*>(&value_);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word += sizeof(int64_t) - sizeof(uint32_t);
+#endif
+        return word;
+    }
+
  private:
     // members
     std::atomic<int64_t> value_;
@@ -47,13 +47,18 @@ class Sequencer {
     // @param buffer_size over which sequences are valid.
     // @param claim_strategy_option for those claiming sequences.
     // @param wait_strategy_option for those waiting on sequences.
+    // @param wait_parameters tunable parameters of the wait strategy.
     Sequencer(int buffer_size,
               ClaimStrategyOption claim_strategy_option,
-              WaitStrategyOption wait_strategy_option) :
+              WaitStrategyOption wait_strategy_option,
+              const WaitStrategyParameters& wait_parameters =
+                WaitStrategyParameters()) :
             buffer_size_(buffer_size),
+            multi_producer_(claim_strategy_option == kMultiThreadedStrategy),
             claim_strategy_(CreateClaimStrategy(claim_strategy_option,
                                                 buffer_size_)),
-            wait_strategy_(CreateWaitStrategy(wait_strategy_option)) { }
+            wait_strategy_(CreateWaitStrategy(wait_strategy_option,
+                                              wait_parameters)) { }
 
     ~Sequencer() {
         delete claim_strategy_;
@@ -149,6 +154,28 @@ class Sequencer {
         Publish(batch_descriptor.end(), batch_descriptor.size());
     }
 
+    // Publish the batch of events without signalling waiting consumers.
+    // The caller issues a sequentially consistent fence and calls
+    // SignalAllAfterFence afterwards, which allows publications on several
+    // sequencers to share a single fence and wake-up pass.
+    //
+    // @return false if the cursor was forced in the mean time.
+    bool PublishWithoutSignal(const BatchDescriptor& batch_descriptor) {
+        claim_strategy_->SerialisePublishing(batch_descriptor.end(), cursor_,
+                                             batch_descriptor.size());
+        if (!multi_producer_) {
+            cursor_.set_sequence(batch_descriptor.end());
+            return true;
+        }
+        return cursor_.CompareAndSet(
+            batch_descriptor.end() - batch_descriptor.size(),
+            batch_descriptor.end());
+    }
+
+    void SignalAllAfterFence() {
+        wait_strategy_->SignalAllAfterFence();
+    }
+
     // Force the publication of a cursor sequence.
     //
     // Only use this method when forcing a sequence and you are sure only one
@@ -171,12 +198,25 @@ class Sequencer {
     // Helpers
     void Publish(const int64_t& sequence, const int64_t& batch_size) {
         claim_strategy_->SerialisePublishing(sequence, cursor_, batch_size);
-        cursor_.set_sequence(sequence);
-        wait_strategy_->SignalAllWhenBlocking();
+        // a single producer updates the cursor with a plain store, which can
+        // overwrite a close (ForcePublish) from another thread, e.g. when
+        // stopping; the producer restores such a close after its last
+        // publication (see Reclose in ProcessorEngine::ExitProcessing)
+        if (!multi_producer_) {
+            cursor_.set_sequence(sequence);
+            wait_strategy_->SignalAllWhenBlocking();
+            return;
+        }
+        // a cursor that was forced in the mean time by another producer
+        // (e.g. to close the sequence) is left alone
+        if (cursor_.CompareAndSet(sequence - batch_size, sequence)) {
+            wait_strategy_->SignalAllWhenBlocking();
+        }
     }
 
     // Members
     const int buffer_size_;
+    const bool multi_producer_;
 
     PaddedSequence cursor_;
     std::vector<Sequence*> gating_sequences_;
@@ -2,7 +2,8 @@
 
 namespace disruptor {
 
-WaitStrategyInterface* CreateWaitStrategy(WaitStrategyOption wait_option) {
+WaitStrategyInterface* CreateWaitStrategy(WaitStrategyOption wait_option,
+        const WaitStrategyParameters& parameters) {
     switch (wait_option) {
         case kBlockingStrategy:
             return new BlockingStrategy();
@@ -12,6 +13,10 @@ WaitStrategyInterface* CreateWaitStrategy(WaitStrategyOption wait_option) {
             return new YieldingStrategy();
         case kBusySpinStrategy:
             return new BusySpinStrategy();
+        case kHybridStrategy:
+            return new HybridStrategy(parameters);
+        case kFutexBlockingStrategy:
+            return new FutexBlockingStrategy();
         default:
             return NULL;
     }
@@ -27,7 +27,13 @@
 #define DISRUPTOR_WAITSTRATEGY_H_  // NOLINT
 
 #include <sys/time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <time.h>
 
+#include <atomic>
+#include <climits>
 #include <chrono>
 #include <thread>
 #include <mutex>
@@ -56,9 +62,56 @@ enum WaitStrategyOption {
     kYieldingStrategy,
     // This strategy call spins in a loop as a waiting strategy which is
     // lowest and most consistent latency but ties up a CPU.
-    kBusySpinStrategy
+    kBusySpinStrategy,
+    // This strategy spins for a bounded number of iterations, then yields
+    // for a bounded number of iterations and finally parks the thread on a
+    // futex. Publishers only issue a wake-up when a consumer is parked.
+    kHybridStrategy,
+    // This strategy parks the event processor on a futex that waits on the
+    // cursor sequence itself. Publishers only issue a wake-up when a consumer
+    // is parked, which avoids the lock and notify of kBlockingStrategy on
+    // every publish.
+    kFutexBlockingStrategy
 };
 
+// Tunable parameters for wait strategies that support them.
+struct WaitStrategyParameters {
+    static const int kDefaultSpinTries = 5000;
+    static const int kDefaultYieldTries = 50;
+
+    WaitStrategyParameters(int spin = kDefaultSpinTries,
+                           int yield = kDefaultYieldTries) :
+        spin_tries(spin < 0 ? 0 : spin),
+        yield_tries(yield < 0 ? 0 : yield) {}
+
+    // number of busy spin iterations before yielding
+    int spin_tries;
+    // number of yield iterations before parking the thread
+    int yield_tries;
+};
+
+// Sleep as long as the 32 bit futex word at address equals expected, until
+// woken up or until timeout_micros has passed (negative: no time out).
+inline void FutexWait(const void* address, uint32_t expected,
+                      int64_t timeout_micros = -1) {
+    if (timeout_micros < 0) {
+        syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected,
+                nullptr, nullptr, 0);
+    } else {
+        struct timespec timeout;
+        timeout.tv_sec = timeout_micros / 1000000;
+        timeout.tv_nsec = (timeout_micros % 1000000) * 1000;
+        syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected,
+                &timeout, nullptr, 0);
+    }
+}
+
+// Wake up all threads sleeping on the futex word at address.
+inline void FutexWakeAll(const void* address) {
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX,
+            nullptr, nullptr, 0);
+}
+
 // Blocking strategy that uses a lock and condition variable for
 // {@link Consumer}s waiting on a barrier.
 // This strategy should be used when performance and low-latency are not as
@@ -362,7 +415,224 @@ class BusySpinStrategy :  public WaitStrategyInterface {
     DISALLOW_COPY_AND_ASSIGN(BusySpinStrategy);
 };
 
-WaitStrategyInterface* CreateWaitStrategy(WaitStrategyOption wait_option);
+// Hybrid strategy that busy spins for a bounded number of iterations, then
+// yields for a bounded number of iterations and finally parks the thread on
+// a futex until the cursor advances.
+// Parked consumers register themselves in a waiter count, such that
+// publishers only need an atomic check when nobody is parked. This strategy
+// gives close to busy spin latency for bursty traffic, without tying up a CPU
+// when the stream is quiet.
+class HybridStrategy :  public WaitStrategyInterface {
+ public:
+    HybridStrategy(const WaitStrategyParameters& parameters =
+                   WaitStrategyParameters()) :
+        spin_tries_(parameters.spin_tries),
+        yield_tries_(parameters.yield_tries),
+        epoch_(0),
+        waiters_(0) {}
+
+    virtual int64_t WaitFor(const std::vector<Sequence*>& dependents,
+                            const Sequence& cursor,
+                            const SequenceBarrierInterface& barrier,
+                            const int64_t& sequence) {
+        int64_t available_sequence = 0;
+        int counter = spin_tries_ + yield_tries_;
+
+        while ((available_sequence = cursor.sequence()) < sequence) {
+            barrier.CheckAlert();
+            if (counter > yield_tries_) {
+                counter--;
+            } else if (counter > 0) {
+                counter--;
+                std::this_thread::yield();
+            } else {
+                Park(cursor, sequence, -1);
+            }
+        }
+
+        if (0 != dependents.size()) {
+            while ((available_sequence = GetMinimumSequence(dependents)) < \
+                    sequence) {
+                barrier.CheckAlert();
+            }
+        }
+
+        return available_sequence;
+    }
+
+    virtual int64_t WaitFor(const std::vector<Sequence*>& dependents,
+                            const Sequence& cursor,
+                            const SequenceBarrierInterface& barrier,
+                            const int64_t& sequence,
+                            const int64_t& timeout_micros) {
+        auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::microseconds(timeout_micros);
+        int64_t available_sequence = 0;
+        int counter = spin_tries_ + yield_tries_;
+
+        while ((available_sequence = cursor.sequence()) < sequence &&
+                timeout_micros > 0) {
+            barrier.CheckAlert();
+            int64_t remaining = std::chrono::duration_cast<
+                std::chrono::microseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) {
+                break;
+            }
+            if (counter > yield_tries_) {
+                counter--;
+            } else if (counter > 0) {
+                counter--;
+                std::this_thread::yield();
+            } else {
+                Park(cursor, sequence, remaining);
+            }
+        }
+
+        if (0 != dependents.size()) {
+            while ((available_sequence = GetMinimumSequence(dependents)) < \
+                    sequence) {
+                barrier.CheckAlert();
+            }
+        }
+
+        return available_sequence;
+    }
+
+    virtual void SignalAllWhenBlocking() {
+        // order the preceding cursor update before the waiter check
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        SignalAllAfterFence();
+    }
+
+    virtual void SignalAllAfterFence() {
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            FutexWakeAll(&epoch_);
+        }
+    }
+
+ private:
+    void Park(const Sequence& cursor, const int64_t& sequence,
+              int64_t timeout_micros) {
+        waiters_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32_t epoch = epoch_.load(std::memory_order_acquire);
+        // the cursor may have advanced before we registered as waiter
+        if (cursor.sequence() < sequence) {
+            FutexWait(&epoch_, epoch, timeout_micros);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    const int spin_tries_;
+    const int yield_tries_;
+
+    std::atomic<uint32_t> epoch_;
+    std::atomic<int> waiters_;
+
+    DISALLOW_COPY_AND_ASSIGN(HybridStrategy);
+};
+
+// Blocking strategy that parks {@link Consumer}s on a futex that waits on
+// the low 32 bits of the cursor sequence.
+// Parked consumers register themselves in a waiter count, such that a
+// publisher only issues a fence and an atomic load when nobody is parked.
+// Since the kernel compares the futex word with the last observed cursor
+// value, a publication that happens just before the consumer goes to sleep
+// is never missed.
+class FutexBlockingStrategy :  public WaitStrategyInterface {
+ public:
+    FutexBlockingStrategy() : cursor_word_(nullptr), waiters_(0) {}
+
+    virtual int64_t WaitFor(const std::vector<Sequence*>& dependents,
+                            const Sequence& cursor,
+                            const SequenceBarrierInterface& barrier,
+                            const int64_t& sequence) {
+        int64_t available_sequence = 0;
+
+        while ((available_sequence = cursor.sequence()) < sequence) {
+            barrier.CheckAlert();
+            Park(cursor, sequence, -1);
+        }
+
+        if (0 != dependents.size()) {
+            while ((available_sequence = GetMinimumSequence(dependents)) < \
+                    sequence) {
+                barrier.CheckAlert();
+            }
+        }
+
+        return available_sequence;
+    }
+
+    virtual int64_t WaitFor(const std::vector<Sequence*>& dependents,
+                            const Sequence& cursor,
+                            const SequenceBarrierInterface& barrier,
+                            const int64_t& sequence,
+                            const int64_t& timeout_micros) {
+        auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::microseconds(timeout_micros);
+        int64_t available_sequence = 0;
+
+        while ((available_sequence = cursor.sequence()) < sequence &&
+                timeout_micros > 0) {
+            barrier.CheckAlert();
+            int64_t remaining = std::chrono::duration_cast<
+                std::chrono::microseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) {
+                break;
+            }
+            Park(cursor, sequence, remaining);
+        }
+
+        if (0 != dependents.size()) {
+            while ((available_sequence = GetMinimumSequence(dependents)) < \
+                    sequence) {
+                barrier.CheckAlert();
+            }
+        }
+
+        return available_sequence;
+    }
+
+    virtual void SignalAllWhenBlocking() {
+        // order the preceding cursor update before the waiter check
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        SignalAllAfterFence();
+    }
+
+    virtual void SignalAllAfterFence() {
+        if (waiters_.load(std::memory_order_acquire) > 0) {
+            FutexWakeAll(cursor_word_.load(std::memory_order_relaxed));
+        }
+    }
+
+ private:
+    void Park(const Sequence& cursor, const int64_t& sequence,
+              int64_t timeout_micros) {
+        // a sequencer has a single cursor, remember it for the publisher
+        cursor_word_.store(cursor.futex_word(), std::memory_order_relaxed);
+        waiters_.fetch_add(1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t current = cursor.sequence();
+        // sleeps only if the cursor did not move since it was read
+        if (current < sequence) {
+            FutexWait(cursor.futex_word(), static_cast<uint32_t>(current),
+                      timeout_micros);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    std::atomic<const void*> cursor_word_;
+    std::atomic<int> waiters_;
+
+    DISALLOW_COPY_AND_ASSIGN(FutexBlockingStrategy);
+};
+
+WaitStrategyInterface* CreateWaitStrategy(WaitStrategyOption wait_option,
+        const WaitStrategyParameters& parameters = WaitStrategyParameters());
 
 };  // namespace disruptor
 
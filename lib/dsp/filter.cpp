@@ -259,7 +259,7 @@ void FirFilter::process_sample( std::vector<double>::iterator input, std::vector
     }
 }
 
-void FirFilter::process_sample( double* input, double* output ) {
+void FirFilter::process_sample( const double* input, double* output ) {
     // skip check if filter has been realized??
 
     double result;
@@ -483,7 +483,7 @@ void BiquadFilter::process_sample( std::vector<double>::iterator input, std::vec
     }
 }
 
-void BiquadFilter::process_sample( double* input, double* output) {
+void BiquadFilter::process_sample( const double* input, double* output) {
     
     if (!realized_) { throw std::runtime_error("Filter has not been realized yet."); }
 
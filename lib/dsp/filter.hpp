@@ -64,7 +64,7 @@ public:
     // all channels, single sample
     virtual void process_sample( std::vector<double>&, std::vector<double>& ) = 0;
     virtual void process_sample( std::vector<double>::iterator, std::vector<double>::iterator ) = 0;
-    virtual void process_sample( double*, double* ) = 0;
+    virtual void process_sample( const double*, double* ) = 0;
     
     // single channel, multiple samples
     virtual void process_channel( std::vector<double> &, std::vector<double> &, unsigned int channel =0 ) = 0;
@@ -106,7 +106,7 @@ public:
     // all channels, single sample
     void process_sample( std::vector<double>& input, std::vector<double>& output ) override final;
     void process_sample( std::vector<double>::iterator input, std::vector<double>::iterator output ) override final;
-    void process_sample( double* input, double* output ) override final;
+    void process_sample( const double* input, double* output ) override final;
     
     // single channel, multiple samples
     void process_channel( std::vector<double> & input, std::vector<double> & output, unsigned int channel=0 ) override final;
@@ -153,7 +153,7 @@ public:
     // all channels, single sample
     void process_sample( std::vector<double>& input, std::vector<double>& output) override final {};
     void process_sample( std::vector<double>::iterator input, std::vector<double>::iterator output) override final;
-    void process_sample( double* input, double* output) override final;
+    void process_sample( const double* input, double* output) override final;
     
     // single channel, multiple samples
     void process_channel( std::vector<double> & input, std::vector<double> & output, unsigned int channel=0 ) override final;
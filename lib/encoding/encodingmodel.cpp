@@ -240,6 +240,18 @@ double EncodingModel::lambda_x( std::size_t grid_index ) {
     return lambda_x_[grid_index];
 }
 
+double EncodingModel::lambda_x( std::size_t grid_index ) const {
+    
+    assert( precomputations_updated_ );
+    assert( grid_index < lambda_x_.size() );
+    return lambda_x_[grid_index];
+}
+
+bool EncodingModel::precomputations_updated() const {
+    
+    return precomputations_updated_;
+}
+
 uint16_t EncodingModel::n_features() const {
     
     return n_spike_features_;
@@ -265,6 +277,11 @@ std::vector<double>& EncodingModel::accumulator() {
     return accumulator_;
 }
 
+const std::vector<double>& EncodingModel::accumulator() const {
+    
+    return accumulator_;
+}
+
 Mixture* EncodingModel::px_model() {
     
     return px_model_;
@@ -280,6 +297,11 @@ Mixture* EncodingModel::pax_model() {
     return pax_model_;
 }
 
+const Mixture* EncodingModel::pax_model() const {
+    
+    return pax_model_;
+}
+
 unsigned int EncodingModel::n_components_pax() const {
     
     return pax_model_->ncomponents;
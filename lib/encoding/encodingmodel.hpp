@@ -90,6 +90,9 @@ public:
     void compute_lambda_x();
     std::vector<double> lambda_x();
     double lambda_x( std::size_t grid_index );
+    // read-only access for shared models, lambda_x must be up to date
+    double lambda_x( std::size_t grid_index ) const;
+    bool precomputations_updated() const;
     
     uint16_t n_features() const;
     
@@ -97,12 +100,14 @@ public:
     void compute_marginal();
     
     std::vector<double>& accumulator();
+    const std::vector<double>& accumulator() const;
     
     void evaluate_px();
     Mixture* px_model();
     unsigned int n_components_px() const;
     
     Mixture* pax_model();
+    const Mixture* pax_model() const;
     unsigned int n_components_pax() const;
     
     unsigned int n_grid_elements() const;
@@ -145,5 +150,12 @@ protected:
     std::array<uint16_t, 1> behavior_array_;
 };
 
+// completes lambda_x before a model version is shared through a snapshot
+// state (see src/graph/snapshotstate.hpp), readers use the const accessors
+inline void PrepareSnapshot( EncodingModel& model ) {
+    
+    if ( not model.precomputations_updated() ) { model.compute_lambda_x(); }
+}
+
 #endif	// encodingmodel.hpp
 
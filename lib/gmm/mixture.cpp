@@ -819,7 +819,7 @@ void mixture_evaluategrid_diagonal( Mixture* mixture, double* grid, uint32_t ngr
     
 }
 
-void mixture_evaluategrid_diagonal_multi( Mixture* mixture, double* grid_acc, uint32_t ngrid, double* points, uint32_t npoints, uint16_t npointsdim, uint16_t* pointsdim, double* output )
+void mixture_evaluategrid_diagonal_multi( const Mixture* mixture, double* grid_acc, uint32_t ngrid, double* points, uint32_t npoints, uint16_t npointsdim, uint16_t* pointsdim, double* output )
 {
     uint32_t P;
     double* current_point = points;
@@ -834,7 +834,7 @@ void mixture_evaluategrid_diagonal_multi( Mixture* mixture, double* grid_acc, ui
     
 }
 
-void mixture_evaluategrid_diagonal( Mixture* mixture, double* grid_acc, uint32_t ngrid, double* testpoint, uint16_t npointsdim, uint16_t* pointsdim, double* output ) {
+void mixture_evaluategrid_diagonal( const Mixture* mixture, double* grid_acc, uint32_t ngrid, double* testpoint, uint16_t npointsdim, uint16_t* pointsdim, double* output ) {
     
     //INPUTS
     
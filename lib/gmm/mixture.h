@@ -100,7 +100,7 @@ typedef struct modellist_t {
 void evaluate( GaussianComponent**, uint32_t, double*, uint32_t, double* );
 void evaluate_diagonal( GaussianComponent**, uint32_t, double*, uint32_t, double* );
 
-void mixture_evaluategrid_diagonal( Mixture*, double*, uint32_t, double*, uint16_t, uint16_t*, double* );
+void mixture_evaluategrid_diagonal( const Mixture*, double*, uint32_t, double*, uint16_t, uint16_t*, double* );
 void mixture_prepare_grid_accumulator( Mixture* , double* , uint32_t , uint16_t , uint16_t* , double* );
 
 void moment_match( GaussianComponent**, uint32_t, GaussianComponent*, uint8_t );
@@ -116,6 +116,6 @@ double compute_mahalanobis_distance( GaussianComponent*, double* );
 
 double mixture_prepare_weights( Mixture*, uint32_t, double );
 
-void mixture_evaluategrid_diagonal_multi( Mixture* mixture, double* grid_acc, uint32_t ngrid, double* points, uint32_t npoints, uint16_t npointsdim, uint16_t* pointsdim, double* output );
+void mixture_evaluategrid_diagonal_multi( const Mixture* mixture, double* grid_acc, uint32_t ngrid, double* points, uint32_t npoints, uint16_t npointsdim, uint16_t* pointsdim, double* output );
 
 #endif /* mixture.h */
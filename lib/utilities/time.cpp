@@ -56,6 +56,21 @@ double compute_delta_ts( uint64_t t1, uint64_t t2 ) {
     return sign*static_cast<double>( diff )*1e-6;
 }
 
+void Pacer::Start( double rate ) {
+    
+    period_ = std::chrono::nanoseconds( rate>0 ? static_cast<int64_t>( 1e9 / rate ) : 0 );
+    next_ = Clock::now();
+}
+
+bool Pacer::Due() {
+    
+    TimePoint now = Clock::now();
+    if (now < next_) { return false; }
+    next_ += period_;
+    if (next_ < now) { next_ = now; }
+    return true;
+}
+
 void TimestampRegister::reset() {
     
     hw = std::numeric_limits<uint64_t>::min();
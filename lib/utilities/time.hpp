@@ -51,6 +51,21 @@ struct TimestampRegister {
     void reset();
 };
 
+// schedule of events at a fixed rate (events/s) for callers that poll, such
+// as stepped processors; after a stall the schedule restarts from the
+// current time instead of bursting to catch up
+class Pacer {
+public:
+    // the first event is due immediately
+    void Start( double rate );
+    // true if the next event is due, in which case the schedule advances
+    bool Due();
+    
+protected:
+    TimePoint next_;
+    std::chrono::nanoseconds period_{0};
+};
+
 #include "time.ipp"
 
 #endif // time.hpp
@@ -99,6 +99,11 @@ bool CommandHandler::HandleCommand( std::deque<std::string>& command, std::deque
         out << YAML::Key << "graph_state" << YAML::Value << local_reply[0];
         out << YAML::Key << "default_test_flag" << YAML::Value << global_context_->test();
         
+        local_command.back() = "placement";
+        DelegateGraphCommand( local_command, local_reply );
+        out << YAML::Key << "cpu_placement" << YAML::Value << YAML::Load( local_reply[0] );
+        out << YAML::EndMap;
+        
         reply.push_back( std::string( out.c_str() ) );
     } else {
         // error
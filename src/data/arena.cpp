@@ -0,0 +1,153 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "arena.hpp"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+#include "g3log/src/g2log.hpp"
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+namespace {
+    
+thread_local std::shared_ptr<Arena> current_arena;
+
+const std::size_t HUGE_PAGE_SIZE = 2*1024*1024;
+
+std::size_t round_up( std::size_t n, std::size_t multiple ) {
+    
+    return ((n + multiple - 1) / multiple) * multiple;
+}
+
+}
+
+std::string item_allocation_to_string( ItemAllocation allocation ) {
+    
+    switch (allocation) {
+        case ItemAllocation::ARENA:
+            return "arena";
+        case ItemAllocation::ARENA_TRANSPARENT_HUGEPAGES:
+            return "transparent_hugepages";
+        case ItemAllocation::ARENA_HUGEPAGES:
+            return "hugepages";
+        default:
+            return "heap";
+    }
+}
+
+ItemAllocation item_allocation_from_string( std::string allocation ) {
+    
+    if (allocation == "heap") {
+        return ItemAllocation::HEAP;
+    } else if (allocation == "arena") {
+        return ItemAllocation::ARENA;
+    } else if (allocation == "transparent_hugepages") {
+        return ItemAllocation::ARENA_TRANSPARENT_HUGEPAGES;
+    } else if (allocation == "hugepages") {
+        return ItemAllocation::ARENA_HUGEPAGES;
+    }
+    
+    throw std::runtime_error( "Unknown item allocation \"" + allocation + "\"." );
+}
+
+Arena::Arena( std::size_t capacity, ItemAllocation allocation, int numa_node ) {
+    
+    if (capacity==0) { return; }
+    
+    std::size_t page_size = sysconf( _SC_PAGESIZE );
+    void* p = MAP_FAILED;
+    
+    if (allocation==ItemAllocation::ARENA_HUGEPAGES) {
+        mapped_ = round_up( capacity, HUGE_PAGE_SIZE );
+        p = mmap( nullptr, mapped_, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+        if (p==MAP_FAILED) {
+            LOG(WARNING) << "No explicit huge pages available for ring buffer arena, using normal pages.";
+        } else {
+            huge_pages_ = true;
+        }
+    }
+    
+    if (p==MAP_FAILED) {
+        mapped_ = round_up( capacity, allocation==ItemAllocation::ARENA_TRANSPARENT_HUGEPAGES ? HUGE_PAGE_SIZE : page_size );
+        p = mmap( nullptr, mapped_, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if (p==MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        
+        if (allocation==ItemAllocation::ARENA_TRANSPARENT_HUGEPAGES) {
+            huge_pages_ = madvise( p, mapped_, MADV_HUGEPAGE )==0;
+        }
+    }
+    
+    // bind before the pages are touched for the first time
+    if (numa_node>=0) {
+        unsigned long nodemask = 1UL << numa_node;
+        numa_bound_ = syscall( SYS_mbind, p, mapped_, MPOL_BIND, &nodemask,
+            sizeof(nodemask)*8, 0 )==0;
+        if (!numa_bound_) {
+            LOG(WARNING) << "Could not bind ring buffer arena to NUMA node " << numa_node << ".";
+        }
+    }
+    
+    base_ = static_cast<char*>(p);
+    capacity_ = mapped_;
+}
+
+Arena::~Arena() {
+    
+    if (base_!=nullptr) {
+        munmap( base_, mapped_ );
+    }
+}
+
+void* Arena::allocate( std::size_t bytes, std::size_t alignment ) {
+    
+    // used_ keeps growing beyond the capacity, such that an arena without
+    // capacity measures the memory that was requested
+    std::size_t offset = round_up( used_, alignment );
+    used_ = offset + bytes;
+    
+    if (used_ > capacity_) { return nullptr; }
+    
+    return base_ + offset;
+}
+
+ArenaScope::ArenaScope( std::shared_ptr<Arena> arena ) : previous_(current_arena) {
+    
+    current_arena = arena;
+}
+
+ArenaScope::~ArenaScope() {
+    
+    current_arena = previous_;
+}
+
+const std::shared_ptr<Arena>& ArenaScope::current() {
+    
+    return current_arena;
+}
@@ -0,0 +1,135 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+/* Arena: single contiguous memory region that holds all items of a ring
+ * buffer and their payloads
+ * 
+ * Memory is handed out with a bump pointer and is only released when the
+ * arena itself is destroyed. The region can be backed by transparent huge
+ * pages (madvise) or explicit huge pages (hugetlbfs, falls back to normal
+ * pages if none are available) and can be bound to a NUMA node.
+ * 
+ * An arena with zero capacity hands out no memory, but still counts the
+ * requested number of bytes. This is used to measure the payload size of
+ * a single item before the real arena is created.
+ */
+
+enum class ItemAllocation { HEAP, ARENA, ARENA_TRANSPARENT_HUGEPAGES, ARENA_HUGEPAGES };
+
+std::string item_allocation_to_string( ItemAllocation allocation );
+ItemAllocation item_allocation_from_string( std::string allocation );
+
+class Arena {
+public:
+    Arena( std::size_t capacity = 0, ItemAllocation allocation = ItemAllocation::ARENA, int numa_node = -1 );
+    ~Arena();
+    
+    Arena( const Arena& ) = delete;
+    Arena& operator=( const Arena& ) = delete;
+    
+    // returns nullptr if the arena is full
+    void* allocate( std::size_t bytes, std::size_t alignment = alignof(std::max_align_t) );
+    bool contains( const void* p ) const { return p>=base_ && p<base_+capacity_; }
+    void* base() const { return base_; }
+    
+    std::size_t capacity() const { return capacity_; }
+    std::size_t used() const { return used_; }
+    bool huge_pages() const { return huge_pages_; }
+    bool numa_bound() const { return numa_bound_; }
+    
+protected:
+    char* base_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t mapped_ = 0;
+    std::size_t used_ = 0;
+    bool huge_pages_ = false;
+    bool numa_bound_ = false;
+};
+
+// While an ArenaScope is alive, PayloadAllocators that are constructed in
+// the same thread allocate from the arena.
+class ArenaScope {
+public:
+    ArenaScope( std::shared_ptr<Arena> arena );
+    ~ArenaScope();
+    
+    static const std::shared_ptr<Arena>& current();
+    
+private:
+    std::shared_ptr<Arena> previous_;
+};
+
+// Allocator for item payloads: allocates from the arena that was current
+// when the allocator was constructed and from the heap otherwise (or when
+// the arena is full). Allocators share ownership of their arena, such that
+// payloads that outlive the data factory (e.g. moved out of an item) remain
+// valid. Copies of a payload are allocated on the heap: the arena only holds
+// the payloads of the ring buffer items, and is not thread-safe.
+template <typename T>
+class PayloadAllocator {
+public:
+    typedef T value_type;
+    
+    PayloadAllocator() : arena_(ArenaScope::current()) {}
+    explicit PayloadAllocator( std::shared_ptr<Arena> arena ) : arena_(arena) {}
+    template <typename U>
+    PayloadAllocator( const PayloadAllocator<U>& other ) : arena_(other.arena()) {}
+    
+    PayloadAllocator select_on_container_copy_construction() const { return PayloadAllocator( nullptr ); }
+    
+    T* allocate( std::size_t n ) {
+        
+        if (arena_!=nullptr) {
+            void* p = arena_->allocate( n*sizeof(T), alignof(T) );
+            if (p!=nullptr) { return static_cast<T*>(p); }
+        }
+        return static_cast<T*>( ::operator new( n*sizeof(T) ) );
+    }
+    
+    void deallocate( T* p, std::size_t n ) {
+        
+        if (arena_==nullptr || !arena_->contains(p)) {
+            ::operator delete( p );
+        }
+    }
+    
+    const std::shared_ptr<Arena>& arena() const { return arena_; }
+    
+    template <typename U>
+    bool operator==( const PayloadAllocator<U>& other ) const { return arena_==other.arena(); }
+    template <typename U>
+    bool operator!=( const PayloadAllocator<U>& other ) const { return arena_!=other.arena(); }
+    
+private:
+    std::shared_ptr<Arena> arena_;
+};
+
+template <typename T>
+using PayloadVector = std::vector<T, PayloadAllocator<T>>;
+
+#endif // arena.hpp
@@ -38,6 +38,7 @@ const std::string BEHAVIORDATA_S = "behavior";
 class BehaviorData : public IData {
 
 public:
+    static constexpr bool FIXED_PAYLOAD = true;
     
     void Initialize( BehaviorUnit unit );
     
@@ -19,6 +19,8 @@
 
 #include "idata.hpp"
 
+#include <algorithm>
+
 bool IData::eos() const {
     
     return end_of_stream_;
@@ -73,6 +75,32 @@ void IData::CloneTimestamps( const IData& data ) {
 
     source_timestamp_ = data.source_timestamp_;
     hardware_timestamp_ = data.hardware_timestamp_;
+    CloneTrace( data );
+}
+
+void IData::CloneTrace( const IData& data ) {
+    
+    trace_.nstamps = data.trace_.nstamps;
+    if (trace_.nstamps>0) {
+        std::copy( data.trace_.stamps, data.trace_.stamps + trace_.nstamps, trace_.stamps );
+    }
+}
+
+void IData::StartTrace( uint32_t hop ) {
+    
+    trace_.nstamps = 0;
+    StampTrace( hop );
+}
+
+void IData::StampTrace( uint32_t hop ) {
+    
+    // stamps beyond the maximum path length are dropped
+    if (trace_.nstamps < DataTrace::MAX_HOPS) {
+        trace_.stamps[trace_.nstamps].hop = hop;
+        trace_.stamps[trace_.nstamps].time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch() ).count();
+        ++trace_.nstamps;
+    }
 }
 	
 void IData::SerializeBinary( std::ostream& stream, Serialization::Format format ) const {
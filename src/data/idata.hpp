@@ -28,6 +28,7 @@
 #include <limits>
 
 #include "../ringbuffer.hpp"
+#include "arena.hpp"
 
 #include "g3log/src/g2log.hpp"
 #include "utilities/time.hpp"
@@ -38,22 +39,73 @@
 const double IRREGULARSTREAM = std::numeric_limits<double>::min();
 
 // Factory for DATATYPE::DATACLASS items with support for post-construction initialization
+// Items are either allocated on the heap, or in an arena that also holds the
+// item payloads (for data classes that use PayloadVector)
 template <typename DATATYPE>
 class DataFactory : public IFactory<typename DATATYPE::DATACLASS> {
 public:
-    DataFactory( DATATYPE& datatype ) : datatype_( datatype ) {}
+    DataFactory( DATATYPE& datatype, ItemAllocation allocation = ItemAllocation::HEAP, int numa_node = -1 ) :
+    datatype_( datatype ), allocation_(allocation), numa_node_(numa_node) {}
     
     virtual typename DATATYPE::DATACLASS* NewInstance( const int& size ) const override final {
         
-        auto items = new typename DATATYPE::DATACLASS[size];
+        typedef typename DATATYPE::DATACLASS DATACLASS;
+        
+        if (allocation_==ItemAllocation::HEAP) {
+            auto items = new DATACLASS[size];
+            for (int k=0; k<size; k++) {
+                datatype_.InitializeData( items[k] );
+            }
+            return items;
+        }
+        
+        // measure the payload of a single item
+        std::size_t payload = 0;
+        {
+            std::shared_ptr<Arena> probe( new Arena() );
+            ArenaScope scope( probe );
+            DATACLASS item;
+            datatype_.InitializeData( item );
+            payload = probe->used();
+        }
+        
+        // items followed by their payloads, with some slack for alignment
+        arena_.reset( new Arena( size * (sizeof(DATACLASS) + payload + ARENA_SLACK_PER_ITEM),
+            allocation_, numa_node_ ) );
+        
+        ArenaScope scope( arena_ );
+        auto items = static_cast<DATACLASS*>( arena_->allocate( size*sizeof(DATACLASS), alignof(DATACLASS) ) );
         for (int k=0; k<size; k++) {
+            new (&items[k]) DATACLASS();
             datatype_.InitializeData( items[k] );
         }
         return items;
     }
+    
+    virtual void DeleteInstance( typename DATATYPE::DATACLASS* items, const int& size ) const override final {
+        
+        if (arena_==nullptr) {
+            delete[] items;
+            return;
+        }
+        
+        typedef typename DATATYPE::DATACLASS DATACLASS;
+        for (int k=0; k<size; k++) {
+            items[k].~DATACLASS();
+        }
+        // payloads that outlive the items keep the arena alive
+        arena_.reset();
+    }
+    
+    const Arena* arena() const { return arena_.get(); }
 
 protected:
     DATATYPE datatype_;
+    ItemAllocation allocation_;
+    int numa_node_;
+    mutable std::shared_ptr<Arena> arena_;
+    
+    static const std::size_t ARENA_SLACK_PER_ITEM = 64;
 };
 
 // Checks if one data type object is compatible with another data type object
@@ -73,6 +125,21 @@ bool CheckDataType( const AbstractType& a, const ConcreteType& c ) {
 #define ASSOCIATED_DATACLASS(T) public:\
 typedef T DATACLASS;\
 
+// Sampled latency trace: fixed-size list of (hop, time) stamps
+// The first stamp marks the claim of the item in the source processor,
+// every following stamp the publication by a processor along the path.
+struct DataTrace {
+    static const unsigned int MAX_HOPS = 8;
+    
+    struct Stamp {
+        uint32_t hop; // identifier of the output slot (assigned by the graph)
+        int64_t time; // steady clock time (ns)
+    };
+    
+    uint32_t nstamps = 0;
+    Stamp stamps[MAX_HOPS];
+};
+
 // Base class for all data classes
 class IData {
 public:
@@ -82,6 +149,18 @@ public:
 	
     virtual void ClearData() = 0;
     
+    // called by the output slot (with the static data class of the slot) right
+    // before publication; data classes that clear lazily hide this to complete
+    // their payload before it is shared with readers
+    void PrepareForPublish() const {}
+    
+    // data classes whose payload storage is sized once by Initialize and is
+    // never reallocated when an item is rewritten hide this with true; only
+    // these can be read through lossy input slots, which the producer may lap
+    // while the reader still holds an item (the reader can then see torn
+    // values, but never freed memory)
+    static constexpr bool FIXED_PAYLOAD = false;
+    
     bool eos() const;
     void set_eos( bool value=true );
     void clear_eos();
@@ -104,6 +183,14 @@ public:
     void set_hardware_timestamp( uint64_t t );
     
     void CloneTimestamps( const IData& data );
+    
+    // latency tracing of sampled items (copied by CloneTimestamps)
+    bool traced() const { return trace_.nstamps>0; }
+    const DataTrace& trace() const { return trace_; }
+    void StartTrace( uint32_t hop );
+    void ClearTrace() { trace_.nstamps = 0; }
+    void StampTrace( uint32_t hop );
+    void CloneTrace( const IData& data );
 	
     virtual void SerializeBinary( std::ostream& stream, Serialization::Format format ) const;
     virtual void SerializeYAML( YAML::Node & node, Serialization::Format format ) const;
@@ -114,6 +201,7 @@ protected:
     uint64_t hardware_timestamp_; // e.g. from Neuralynx
     uint64_t serial_number_;
     bool end_of_stream_ = false;
+    DataTrace trace_;
 };
 
 // Base class for all data types
@@ -60,17 +60,20 @@ void LikelihoodData::set_time_bin( double buffer_size ) {
 void LikelihoodData::set_log_likelihood(std::valarray<double>& log_likelihood) {
     
     log_likelihood_ = log_likelihood;
+    log_likelihood_cleared_ = false;
     likelihood_is_updated_ = false;
 }
 
 void LikelihoodData::set_log_likelihood(double log_likelihood_value, size_t grid_index) {
     
+    materialize();
     log_likelihood_[grid_index] = log_likelihood_value;
     likelihood_is_updated_ = false;
 }
 
 void LikelihoodData::set_log_likelihood(double* log_likelihood_values, size_t grid_size) {
     
+    if (grid_size < grid_size_) { materialize(); }
     for (decltype(grid_size) g = 0; g < grid_size; ++g) {
         // additional checks are fine because this method is not going to be used
         // in graphs dedicated to real-time processing 
@@ -80,12 +83,14 @@ void LikelihoodData::set_log_likelihood(double* log_likelihood_values, size_t gr
             throw std::runtime_error("Invalid address at grid " + std::to_string(g));
         }
     }
+    log_likelihood_cleared_ = false;
     likelihood_is_updated_ = false;
     cached_integral_likelihood_ = INTEGRAL_OBSOLETE;
 }
 
 const std::valarray<double>& LikelihoodData::log_likelihood() const {
     
+    materialize();
     return log_likelihood_;
 }
 
@@ -96,6 +101,7 @@ double LikelihoodData::likelihood(std::size_t grid_index) {
 
 void LikelihoodData::decrement_loglikelihood(double amount, size_t grid_index) {
     
+    materialize();
     log_likelihood_[grid_index] -= amount;
     likelihood_is_updated_ = false;
     cached_integral_likelihood_ = INTEGRAL_OBSOLETE;
@@ -103,6 +109,7 @@ void LikelihoodData::decrement_loglikelihood(double amount, size_t grid_index) {
 
 void LikelihoodData::increment_loglikelihood(double amount, size_t grid_index) {
     
+    materialize();
     log_likelihood_[grid_index] += amount;
     likelihood_is_updated_ = false;
     cached_integral_likelihood_ = INTEGRAL_OBSOLETE;
@@ -111,7 +118,7 @@ void LikelihoodData::increment_loglikelihood(double amount, size_t grid_index) {
 const std::valarray<double>& LikelihoodData::likelihood() {
     
     if (!likelihood_is_updated_) {
-        cached_likelihood_ = compute_likelihood( log_likelihood_ );
+        cached_likelihood_ = compute_likelihood( log_likelihood() );
         likelihood_is_updated_ = true;
     }
     return cached_likelihood_;
@@ -145,7 +152,13 @@ void LikelihoodData::multiply_likelihood_inplace ( LikelihoodData* other,
     bool log_space ) {
     
     if (log_space) {
-        log_likelihood_ += other->log_likelihood();
+        if (log_likelihood_cleared_) {
+            // no need to reset a cleared log likelihood first
+            log_likelihood_ = other->log_likelihood() + DEFAULT_LOG_LIKELIHOOD_VALUE;
+            log_likelihood_cleared_ = false;
+        } else {
+            log_likelihood_ += other->log_likelihood();
+        }
         likelihood_is_updated_ = false;
         cached_integral_likelihood_ = INTEGRAL_OBSOLETE;
     } else {
@@ -166,6 +179,7 @@ void LikelihoodData::accumulate_likelihood( LikelihoodData* other,  bool log_spa
 
 std::size_t LikelihoodData::argmax() const {
     
+    materialize();
     std::size_t argmax = 0, i;
     double value = log_likelihood_[argmax];
     double max_current_value = value;
@@ -190,16 +204,21 @@ void LikelihoodData::ClearData() {
     
     n_spikes_ = 0;
     
-    log_likelihood_.resize(grid_size_);
-    log_likelihood_ = DEFAULT_LOG_LIKELIHOOD_VALUE;
-    likelihood_is_updated_ = true; // default_likelihood = exp(default_log_likelihood)
-    cached_likelihood_.resize(grid_size_);
-    cached_likelihood_ = DEFAULT_LIKELIHOOD_VALUE;
-    cached_integral_likelihood_ = cached_likelihood_.sum();
+    if (log_likelihood_.size()!=grid_size_) {
+        log_likelihood_.resize(grid_size_);
+        cached_likelihood_.resize(grid_size_);
+    }
+    
+    // O(1): the log likelihood is reset on first use (see materialize) and
+    // the likelihood is recomputed when asked for
+    log_likelihood_cleared_ = true;
+    likelihood_is_updated_ = false;
+    cached_integral_likelihood_ = grid_size_ * DEFAULT_LIKELIHOOD_VALUE;
 }
 
 const double& LikelihoodData::operator[](std::size_t idx) const {
     
+    materialize();
     return log_likelihood_[idx]; 
 }
 
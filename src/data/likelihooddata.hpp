@@ -61,6 +61,7 @@ public:
     double mua() const;
     
     virtual void ClearData() override;
+    void PrepareForPublish() const { materialize(); }
     
     void YAMLDescription( YAML::Node & node,
         Serialization::Format format = Serialization::Format::FULL ) const override;
@@ -84,8 +85,17 @@ protected:
     std::valarray<double> compute_likelihood( std::valarray<double> log_likelihood ) const;
     std::valarray<double> normalized_log_likelihood();
     
+    // reset a cleared log likelihood on first use
+    void materialize() const {
+        if (log_likelihood_cleared_) {
+            log_likelihood_ = DEFAULT_LOG_LIKELIHOOD_VALUE;
+            log_likelihood_cleared_ = false;
+        }
+    }
+    
 protected:
-    std::valarray<double> log_likelihood_;
+    mutable std::valarray<double> log_likelihood_;
+    mutable bool log_likelihood_cleared_ = false;
     bool likelihood_is_updated_;
     std::valarray<double> cached_likelihood_;
     double cached_integral_likelihood_;
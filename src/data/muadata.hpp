@@ -25,6 +25,8 @@
 
 class MUAData : public IData {
 public:
+    static constexpr bool FIXED_PAYLOAD = true;
+    
     void Initialize( double bin_size );
     
     virtual void ClearData() override;
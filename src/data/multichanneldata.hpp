@@ -34,6 +34,8 @@ typedef Range<size_t> SampleRange;
 template <typename T>
 class MultiChannelData : public IData {
 public:
+    // payload is sized by Initialize only
+    static constexpr bool FIXED_PAYLOAD = true;
     
     typedef stride_iter<T*> channel_iterator;
     typedef T* sample_iterator;
@@ -45,10 +47,16 @@ public:
         Initialize( nchannels, nchannels, sample_rate );
     }
 
+    // only the samples written since the last clear are reset (see mark_dirty)
     virtual void ClearData() override {
         
-        std::fill( data_.begin(), data_.end(), 0);
-        std::fill( timestamps_.begin(), timestamps_.end(), 0);
+        size_t end = std::min( dirty_end_, nsamples_ );
+        if (dirty_begin_ < end) {
+            std::fill( data_.begin() + flat_index(dirty_begin_), data_.begin() + flat_index(end), 0);
+            std::fill( timestamps_.begin() + dirty_begin_, timestamps_.begin() + end, 0);
+        }
+        dirty_begin_ = nsamples_;
+        dirty_end_ = 0;
         is_duplicate_ = false;
     }
 
@@ -68,6 +76,7 @@ public:
         data_.resize( nchannels_*nsamples_ );
         timestamps_.resize( nsamples_ );
         is_duplicate_ = false;
+        mark_dirty();
     }
 	
     size_t nchannels() const { return nchannels_; }
@@ -75,7 +84,8 @@ public:
     double sample_rate() const { return sample_rate_; }
        
     uint64_t sample_timestamp( size_t sample = 0 ) const { return timestamps_[sample]; }
-    std::vector<uint64_t>& sample_timestamps() { return timestamps_; }
+    PayloadVector<uint64_t>& sample_timestamps() { mark_dirty(); return timestamps_; }
+    const PayloadVector<uint64_t>& sample_timestamps() const { return timestamps_; }
     
     void set_sample_timestamp( size_t sample, uint64_t t ) {
         
@@ -83,19 +93,29 @@ public:
             throw std::out_of_range(". Sample index " + std::to_string(sample) +
                 " out of range. Max index is " + std::to_string(nsamples_-1) );
         } else {
+            mark_dirty( sample );
             timestamps_[sample] = t;
         }
     }
     
-    void set_sample_timestamps( std::vector<uint64_t> &t ) {
+    void set_sample_timestamps( const std::vector<uint64_t> &t ) {
+
+        assert( t.size() == nsamples_ );
+        mark_dirty();
+        timestamps_.assign( t.begin(), t.end() );
+    }
+    
+    void set_sample_timestamps( const PayloadVector<uint64_t> &t ) {
 
         assert( t.size() == nsamples_ );
-        timestamps_ = t;
+        mark_dirty();
+        timestamps_.assign( t.begin(), t.end() );
     }
     
     void set_data_channel( size_t channel, std::vector<T>& data ) {
 
         assert( data.size() == nsamples_ );
+        mark_dirty();
         T* ptr = data_.data();
         for (size_t k=0; k<nsamples_; ++k ) {
             (*ptr)=data[k];
@@ -119,6 +139,7 @@ public:
             throw std::out_of_range(". Channel index " + std::to_string(sample) +
                 " out of range. Max index is " + std::to_string(nchannels_-1) ) ;
         }
+        mark_dirty( sample );
         data_[flat_index(sample,channel)] = data;
     }
     
@@ -132,19 +153,21 @@ public:
         is_duplicate_ = false;
     }
     
-    std::vector<T>& data() { return data_; }
+    PayloadVector<T>& data() { mark_dirty(); return data_; }
+    const PayloadVector<T>& data() const { return data_; }
     
     const T& data_sample( size_t sample, size_t channel = 0 ) const { return data_[flat_index(sample,channel)]; }
 	
-    T& operator()( size_t index ) { return data_[index]; }
+    T& operator()( size_t index ) { mark_dirty( index / nchannels_ ); return data_[index]; }
     const T& operator()( size_t index ) const { return data_[index]; }
     
-    T& operator()( size_t sample, size_t channel = 0 ) { return data_[flat_index(sample,channel)]; }
+    T& operator()( size_t sample, size_t channel = 0 ) { mark_dirty( sample ); return data_[flat_index(sample,channel)]; }
     const T& operator()( size_t sample, size_t channel = 0 ) const { return data_[flat_index(sample,channel)]; }
 	
     // iterators
     T* begin_sample( size_t sample ) {
         
+        mark_dirty( sample );
         return &data_[flat_index(sample)];
     }
     
@@ -166,7 +189,8 @@ public:
     
     stride_iter<T*> begin_channel( size_t channel ) {
         
-        return stride_iter<T*>(&data[channel],nchannels_);
+        mark_dirty();
+        return stride_iter<T*>(&data_[channel],nchannels_);
     }
     
     stride_iter<T*> end_channel( size_t channel ) {
@@ -174,6 +198,16 @@ public:
         return begin_channel(channel) + nsamples_;
     }
     
+    stride_iter<const T*> begin_channel( size_t channel ) const {
+        
+        return stride_iter<const T*>(&data_[channel],nchannels_);
+    }
+    
+    stride_iter<const T*> end_channel( size_t channel ) const {
+        
+        return begin_channel(channel) + nsamples_;
+    }
+    
     T sum_abs_sample( size_t sample ) const {
         
         return std::accumulate( begin_sample(sample), end_sample(sample), 0, [](T a, T b) { return a + std::abs(b); } );
@@ -228,9 +262,9 @@ public:
             
         IData::SerializeYAML( node, format );
         if (format==Serialization::Format::FULL || format==Serialization::Format::COMPACT) {
-            node["timestamps"] = timestamps_;
+            node["timestamps"] = std::vector<uint64_t>( timestamps_.begin(), timestamps_.end() );
             // TODO: write samples individually to list of lists, instead of a single flat list
-            node["signal"] = data_;
+            node["signal"] = std::vector<T>( data_.begin(), data_.end() );
         }
         if ( format==Serialization::Format::FULL ) {
             node["is_duplicate"] = is_duplicate_;
@@ -257,13 +291,31 @@ protected:
     inline size_t flat_index( size_t sample, size_t channel ) const { return channel + sample*nchannels_; }
     inline size_t flat_index( size_t sample ) const { return sample*nchannels_; }
     
+    // extent of samples that may have been written since the last clear;
+    // only the non-const accessors used by the producer track it, readers
+    // of published items must use the const accessors
+    void mark_dirty( size_t sample ) {
+        
+        if (sample < dirty_begin_) { dirty_begin_ = sample; }
+        if (sample >= dirty_end_) { dirty_end_ = sample + 1; }
+    }
+    
+    void mark_dirty() {
+        
+        dirty_begin_ = 0;
+        dirty_end_ = nsamples_;
+    }
+    
 protected:
     size_t nchannels_;
     size_t nsamples_;
     double sample_rate_;
-    std::vector<T> data_;
-    std::vector<uint64_t> timestamps_;
+    // payload is allocated in the ring buffer arena, if enabled
+    PayloadVector<T> data_;
+    PayloadVector<uint64_t> timestamps_;
     bool is_duplicate_;
+    size_t dirty_begin_ = 0;
+    size_t dirty_end_ = 0;
 };
 
 template<typename T>
@@ -20,6 +20,8 @@
 #ifndef SCALARDATA_H
 #define SCALARDATA_H
 
+#include <type_traits>
+
 #include "idata.hpp"
 #include "utilities/string.hpp"
 
@@ -29,6 +31,8 @@ template <class TYPE>
 class ScalarData : public IData {
     
 public:
+    static constexpr bool FIXED_PAYLOAD = std::is_trivially_copyable<TYPE>::value;
+    
     ScalarData( TYPE data = DEFAULT_SCALAR_VALUE ) : data_(data) {}
     
     virtual void ClearData() override {}
@@ -28,6 +28,8 @@ const std::string VIDEOTRACKDATA_S = "vt";
 class VideoTrackData : public IData {
 
 public:
+    static constexpr bool FIXED_PAYLOAD = true;
+    
     
     void Initialize( double sample_rate, std::array<int, 2> resolution );
     
@@ -76,6 +76,11 @@ void StreamOutConnector::Connect( StreamInConnector* downstream ) {
     port()->Connect( address_.slot(), downstream );
 }
 
+void StreamOutConnector::Disconnect( StreamInConnector* downstream ) {
+    
+    port()->Disconnect( address_.slot(), downstream );
+}
+
 IStreamInfo& StreamOutConnector::streaminfo() {
     
     processor()->NegotiateConnections();
@@ -122,6 +127,11 @@ void StreamInConnector::Connect( StreamOutConnector* upstream ) {
     port()->Connect( address_.slot(), upstream );
 }
 
+void StreamInConnector::Disconnect( StreamOutConnector* upstream ) {
+    
+    port()->Disconnect( address_.slot(), upstream );
+}
+
 bool StreamInConnector::CheckCompatibility( StreamOutConnector* upstream ) {
     
     return port()->CheckCompatibility( upstream->port() );
@@ -152,4 +162,14 @@ void StreamConnection::Connect(const ProcessorEngineMap& processors) {
     
     connected_.store(true);
 }
+
+void StreamConnection::Disconnect() {
+    
+    if (!connected()) { return; }
+    
+    in_connector_->Disconnect( out_connector_.get() );
+    out_connector_->Disconnect( in_connector_.get() );
+    
+    connected_.store(false);
+}
      
@@ -75,6 +75,7 @@ public:
     ISlotOut* slot();
     
     void Connect( StreamInConnector* downstream );
+    void Disconnect( StreamInConnector* downstream );
     
     const SlotAddress& address() const { return address_; }
     
@@ -96,6 +97,7 @@ public:
     ISlotIn* slot();
     
     void Connect( StreamOutConnector* upstream );
+    void Disconnect( StreamOutConnector* upstream );
     
     bool CheckCompatibility( StreamOutConnector* upstream );
     
@@ -116,6 +118,12 @@ public:
     bool connected() const { return connected_.load(); }
     
     void Connect( const ProcessorEngineMap& processors );
+    // detach both endpoints, such that one of them can be destroyed while
+    // the other one is kept (see ProcessorGraph::RemoveProcessors)
+    void Disconnect();
+    
+    StreamOutConnector* out_connector() { return out_connector_.get(); }
+    StreamInConnector* in_connector() { return in_connector_.get(); }
     
     std::string string() const {
         std::string s;
@@ -127,6 +135,12 @@ public:
         return s;
     }
     
+    // connection rule as written in the graph definition (i.e. before
+    // default ports and slots have been resolved)
+    std::string rule() const { return out_.string() + "=" + in_.string(); }
+    const SlotAddress& out_address() const { return out_; }
+    const SlotAddress& in_address() const { return in_; }
+    
 protected:
     SlotAddress out_;
     SlotAddress in_;
@@ -0,0 +1,342 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "cpuplacement.hpp"
+#include "g3log/src/g2log.hpp"
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+bool read_sysfs( std::string path, std::string& value ) {
+    
+    std::ifstream file( path );
+    if (!file.good()) { return false; }
+    std::getline( file, value );
+    return !file.fail();
+}
+
+int read_sysfs_int( std::string path, int default_value ) {
+    
+    std::string value;
+    if (!read_sysfs( path, value )) { return default_value; }
+    try {
+        return std::stoi( value );
+    } catch (std::exception& e) {
+        return default_value;
+    }
+}
+
+}
+
+std::set<int> parse_cpu_list( std::string list ) {
+    
+    std::set<int> cpus;
+    std::stringstream ss( list );
+    std::string item;
+    
+    while (std::getline( ss, item, ',' )) {
+        if (item.empty() || item=="\n") { continue; }
+        auto dash = item.find( '-' );
+        try {
+            if (dash==std::string::npos) {
+                cpus.insert( std::stoi( item ) );
+            } else {
+                int first = std::stoi( item.substr( 0, dash ) );
+                int last = std::stoi( item.substr( dash+1 ) );
+                for (int k=first; k<=last; ++k) { cpus.insert( k ); }
+            }
+        } catch (std::exception& e) {
+            throw std::runtime_error( "Invalid cpu list \"" + list + "\"." );
+        }
+    }
+    
+    return cpus;
+}
+
+int numa_node_of_cpu( int cpu, std::string root ) {
+    
+    if (cpu<0) { return -1; }
+    
+    // the cpu directory contains a nodeX link to its NUMA node
+    DIR* dir = opendir( (root + "/cpu" + std::to_string(cpu)).c_str() );
+    if (dir==nullptr) { return -1; }
+    
+    int node = -1;
+    while (struct dirent* entry = readdir( dir )) {
+        std::string name( entry->d_name );
+        if (name.size()>4 && name.compare( 0, 4, "node" )==0 &&
+            std::all_of( name.begin()+4, name.end(), ::isdigit )) {
+            node = std::stoi( name.substr(4) );
+            break;
+        }
+    }
+    closedir( dir );
+    
+    return node;
+}
+
+CpuTopology CpuTopology::FromSysfs( std::string root ) {
+    
+    CpuTopology topology;
+    std::string value;
+    
+    std::set<int> online;
+    if (read_sysfs( root + "/online", value )) {
+        online = parse_cpu_list( value );
+    } else {
+        long n = sysconf( _SC_NPROCESSORS_ONLN );
+        for (int k=0; k<n; ++k) { online.insert( k ); }
+    }
+    
+    std::set<int> isolated;
+    if (read_sysfs( root + "/isolated", value )) {
+        isolated = parse_cpu_list( value );
+    }
+    if (read_sysfs( root + "/nohz_full", value ) && value!="(null)") {
+        auto nohz = parse_cpu_list( value );
+        isolated.insert( nohz.begin(), nohz.end() );
+    }
+    
+    for (auto cpu : online) {
+        
+        CpuInfo info;
+        std::string base = root + "/cpu" + std::to_string(cpu);
+        
+        info.cpu = cpu;
+        info.package = read_sysfs_int( base + "/topology/physical_package_id", 0 );
+        info.core = read_sysfs_int( base + "/topology/core_id", cpu );
+        info.isolated = isolated.count( cpu )==1;
+        
+        if (read_sysfs( base + "/topology/thread_siblings_list", value )) {
+            for (auto sibling : parse_cpu_list( value )) {
+                if (sibling!=cpu && online.count(sibling)==1) { info.siblings.push_back( sibling ); }
+            }
+        }
+        
+        // L3 cache domain, identified by the first cpu that shares the cache;
+        // fall back to the package if there is no L3 cache
+        info.l3 = -1;
+        for (int index=0; ; ++index) {
+            std::string cache = base + "/cache/index" + std::to_string(index);
+            int level = read_sysfs_int( cache + "/level", -1 );
+            if (level<0) { break; }
+            if (level==3 && read_sysfs( cache + "/shared_cpu_list", value )) {
+                auto shared = parse_cpu_list( value );
+                if (!shared.empty()) { info.l3 = *shared.begin(); }
+                break;
+            }
+        }
+        if (info.l3<0) { info.l3 = -1 - info.package; }
+        
+        topology.cpus_.push_back( info );
+    }
+    
+    return topology;
+}
+
+const CpuInfo& CpuTopology::cpu( int cpu ) const {
+    
+    for (auto & it : cpus_) {
+        if (it.cpu==cpu) { return it; }
+    }
+    throw std::out_of_range( "Unknown cpu " + std::to_string(cpu) + "." );
+}
+
+bool CpuTopology::has_cpu( int cpu ) const {
+    
+    for (auto & it : cpus_) {
+        if (it.cpu==cpu) { return true; }
+    }
+    return false;
+}
+
+bool CpuTopology::has_isolated() const {
+    
+    for (auto & it : cpus_) {
+        if (it.isolated) { return true; }
+    }
+    return false;
+}
+
+YAML::Node CpuTopology::ExportYAML() const {
+    
+    YAML::Node node;
+    for (auto & it : cpus_) {
+        YAML::Node cpu;
+        cpu["package"] = it.package;
+        cpu["core"] = it.core;
+        cpu["l3"] = it.l3;
+        cpu["isolated"] = it.isolated;
+        node[std::to_string(it.cpu)] = cpu;
+    }
+    return node;
+}
+
+namespace {
+
+class Placer {
+public:
+    Placer( const CpuTopology& topology ) : topology_(topology) {
+        
+        for (auto & it : topology_.cpus()) { load_[it.cpu] = 0; }
+    }
+    
+    // pick least loaded cpu from candidates, optionally close to anchor cpu
+    int pick( bool isolated, int anchor = -1 ) const {
+        
+        bool use_isolated = isolated && topology_.has_isolated();
+        
+        int best = -1;
+        int best_score = 0;
+        
+        for (auto & it : topology_.cpus()) {
+            
+            // isolated cpus are reserved for critical tasks, unless there
+            // are no other cpus
+            if (it.isolated!=use_isolated && !all_isolated()) { continue; }
+            
+            int score = load_.at(it.cpu) * 100;
+            for (auto sibling : it.siblings) { score += load_.at(sibling) * 10; }
+            
+            if (anchor>=0) {
+                const CpuInfo& a = topology_.cpu( anchor );
+                if (it.l3!=a.l3) { score += 50; }
+                if (std::find( a.siblings.begin(), a.siblings.end(), it.cpu )!=a.siblings.end()) { score += 5; }
+            }
+            
+            if (best<0 || score<best_score) {
+                best = it.cpu;
+                best_score = score;
+            }
+        }
+        
+        return best;
+    }
+    
+    void use( int cpu ) { if (load_.count(cpu)==1) { ++load_[cpu]; } }
+    
+protected:
+    bool all_isolated() const {
+        
+        for (auto & it : topology_.cpus()) {
+            if (!it.isolated) { return false; }
+        }
+        return true;
+    }
+    
+protected:
+    const CpuTopology& topology_;
+    std::map<int,int> load_;
+};
+
+}
+
+std::vector<PlacementEntry> PlanCpuPlacement( const CpuTopology& topology,
+    const std::vector<PlacementTask>& tasks, std::vector<PlacementEdge> edges ) {
+    
+    std::map<std::string, PlacementEntry> placed;
+    Placer placer( topology );
+    
+    if (topology.cpus().empty()) { return std::vector<PlacementEntry>(); }
+    
+    // keep explicitly requested cores; a core that is offline or does not
+    // exist leaves the task unpinned (as when pinning fails)
+    for (auto & task : tasks) {
+        if (task.requested_core==CORE_NOT_PINNED) { continue; }
+        if (!topology.has_cpu( task.requested_core )) {
+            LOG(WARNING) << "CPU placement: requested core " << task.requested_core << " of " << task.name
+                << " is not available. Thread will not be pinned.";
+            placed[task.name] = PlacementEntry{ task.name, CORE_NOT_PINNED, "requested core not available" };
+            continue;
+        }
+        placed[task.name] = PlacementEntry{ task.name, task.requested_core, "requested in graph definition" };
+        placer.use( task.requested_core );
+    }
+    
+    // critical tasks get a (preferably isolated) core of their own
+    for (auto & task : tasks) {
+        if (placed.count(task.name)==1 || !task.critical) { continue; }
+        int cpu = placer.pick( true );
+        placer.use( cpu );
+        placed[task.name] = PlacementEntry{ task.name, static_cast<ThreadCore>(cpu),
+            topology.cpu(cpu).isolated ? "critical, isolated core" : "critical, no isolated core available" };
+    }
+    
+    // place producer/consumer pairs close together, highest stream rate first
+    std::stable_sort( edges.begin(), edges.end(),
+        []( const PlacementEdge& a, const PlacementEdge& b ) { return a.rate > b.rate; } );
+    
+    auto place_near = [&]( const std::string& task, const std::string& other, double rate ) {
+        
+        int anchor = placed.count(other)==1 ? placed[other].core : -1;
+        int cpu = placer.pick( false, anchor );
+        placer.use( cpu );
+        
+        std::string reason = "balanced";
+        if (anchor>=0) {
+            std::ostringstream ss;
+            ss << (topology.cpu(cpu).l3==topology.cpu(anchor).l3 ? "shares L3 with " : "near ")
+               << other << " (" << rate << " Hz)";
+            reason = ss.str();
+        }
+        placed[task] = PlacementEntry{ task, static_cast<ThreadCore>(cpu), reason };
+    };
+    
+    for (auto & edge : edges) {
+        bool from_placed = placed.count(edge.from)==1;
+        bool to_placed = placed.count(edge.to)==1;
+        
+        if (from_placed && to_placed) { continue; }
+        
+        if (!from_placed) { place_near( edge.from, edge.to, edge.rate ); }
+        if (!to_placed) { place_near( edge.to, edge.from, edge.rate ); }
+    }
+    
+    // remaining tasks without any streams
+    for (auto & task : tasks) {
+        if (placed.count(task.name)==0) {
+            place_near( task.name, "", 0 );
+        }
+    }
+    
+    std::vector<PlacementEntry> plan;
+    for (auto & task : tasks) {
+        plan.push_back( placed[task.name] );
+    }
+    
+    return plan;
+}
+
+YAML::Node ExportPlacementYAML( const std::vector<PlacementEntry>& plan ) {
+    
+    YAML::Node node;
+    for (auto & it : plan) {
+        node[it.task]["core"] = it.core;
+        node[it.task]["reason"] = it.reason;
+    }
+    return node;
+}
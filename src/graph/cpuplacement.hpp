@@ -0,0 +1,100 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#ifndef CPUPLACEMENT_H
+#define CPUPLACEMENT_H
+
+#include <string>
+#include <vector>
+#include <set>
+
+#include "threadutilities.hpp"
+#include "yaml-cpp/yaml.h"
+
+/* Automatic placement of processor threads on CPU cores
+ * 
+ * CpuTopology describes the online CPUs of the machine (package, physical
+ * core, L3 cache domain) and which of them are isolated from the general
+ * scheduler (isolcpus or nohz_full), as read from sysfs.
+ * 
+ * PlanCpuPlacement assigns a core to every thread (placement task), given
+ * the data streams between them (placement edges, weighted by stream rate):
+ * - cores that were explicitly requested are kept
+ * - critical tasks (e.g. acquisition or stimulation) get a core of their own,
+ *   preferably an isolated one
+ * - the remaining tasks are placed in order of decreasing stream rate, such
+ *   that producer/consumer pairs share an L3 cache domain, while avoiding
+ *   cores (and SMT siblings) that are already in use
+ */
+
+struct CpuInfo {
+    int cpu;
+    int package;
+    int core;
+    int l3;
+    bool isolated;
+    std::vector<int> siblings; // SMT siblings, excluding cpu itself
+};
+
+class CpuTopology {
+public:
+    // read topology from sysfs, falls back to a flat topology on failure
+    static CpuTopology FromSysfs( std::string root = "/sys/devices/system/cpu" );
+    
+    const std::vector<CpuInfo>& cpus() const { return cpus_; }
+    const CpuInfo& cpu( int cpu ) const;
+    bool has_cpu( int cpu ) const;
+    bool has_isolated() const;
+    
+    YAML::Node ExportYAML() const;
+    
+protected:
+    std::vector<CpuInfo> cpus_;
+};
+
+// parse a sysfs cpu list, e.g. "0-3,8,10-11"
+std::set<int> parse_cpu_list( std::string list );
+
+// NUMA node of a cpu, or -1 if unknown
+int numa_node_of_cpu( int cpu, std::string root = "/sys/devices/system/cpu" );
+
+struct PlacementTask {
+    std::string name;
+    bool critical;
+    ThreadCore requested_core;
+};
+
+struct PlacementEdge {
+    std::string from;
+    std::string to;
+    double rate; // stream rate in Hz
+};
+
+struct PlacementEntry {
+    std::string task;
+    ThreadCore core;
+    std::string reason;
+};
+
+std::vector<PlacementEntry> PlanCpuPlacement( const CpuTopology& topology,
+    const std::vector<PlacementTask>& tasks, std::vector<PlacementEdge> edges );
+
+YAML::Node ExportPlacementYAML( const std::vector<PlacementEntry>& plan );
+
+#endif // cpuplacement.hpp
@@ -0,0 +1,126 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+//
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+//
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#ifndef DATAVIEW_H
+#define DATAVIEW_H
+
+#include <cstddef>
+#include <iterator>
+
+/* DataView: non-owning view on a range of items in a ring buffer
+ *
+ * The items are stored contiguously in the ring buffer, so a range of
+ * sequences maps onto at most two contiguous segments (two when the range
+ * wraps around the end of the buffer). Items are addressed with a byte stride
+ * equal to the size of the upstream data class, which makes the view valid
+ * also when DATACLASS is a base class of the upstream data class (e.g. IData).
+ *
+ * A view is only valid until the data is released by the input slot.
+ */
+template <typename DATACLASS>
+class DataView {
+public:
+    class iterator : public std::iterator<std::forward_iterator_tag, DATACLASS*> {
+    public:
+        iterator( const DataView* view, unsigned int segment, std::size_t index ) :
+        view_(view), segment_(segment), index_(index) {}
+
+        DATACLASS* operator*() const { return view_->item( segment_, index_ ); }
+
+        iterator& operator++() {
+            if (++index_ == view_->size_[segment_] && segment_+1 < view_->nsegments_) {
+                ++segment_;
+                index_ = 0;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) { iterator tmp(*this); ++(*this); return tmp; }
+
+        bool operator==( const iterator& other ) const { return segment_==other.segment_ && index_==other.index_; }
+        bool operator!=( const iterator& other ) const { return !(*this==other); }
+
+    private:
+        const DataView* view_;
+        unsigned int segment_;
+        std::size_t index_;
+    };
+
+    DataView() : stride_(0), nsegments_(0) { size_[0] = size_[1] = 0; }
+
+    void clear() { nsegments_ = 0; size_[0] = size_[1] = 0; }
+
+    // map n items starting at ring index first onto one or two segments
+    void assign( DATACLASS* base, std::size_t stride, std::size_t ring_size, std::size_t first, std::size_t n ) {
+
+        stride_ = stride;
+        first = first % ring_size;
+        begin_[0] = reinterpret_cast<char*>(base) + first*stride;
+        if (first + n <= ring_size) {
+            size_[0] = n;
+            size_[1] = 0;
+            nsegments_ = n>0 ? 1 : 0;
+        } else {
+            size_[0] = ring_size - first;
+            begin_[1] = reinterpret_cast<char*>(base);
+            size_[1] = n - size_[0];
+            nsegments_ = 2;
+        }
+    }
+
+    // view on a single item (e.g. a cached item)
+    void assign( DATACLASS* item ) {
+
+        stride_ = 0;
+        begin_[0] = reinterpret_cast<char*>(item);
+        size_[0] = 1;
+        size_[1] = 0;
+        nsegments_ = 1;
+    }
+
+    std::size_t size() const { return size_[0] + size_[1]; }
+    bool empty() const { return size()==0; }
+
+    unsigned int nsegments() const { return nsegments_; }
+    std::size_t segment_size( unsigned int segment ) const { return size_[segment]; }
+
+    DATACLASS* item( unsigned int segment, std::size_t index ) const {
+
+        return reinterpret_cast<DATACLASS*>( begin_[segment] + index*stride_ );
+    }
+
+    DATACLASS* operator[]( std::size_t index ) const {
+
+        return index < size_[0] ? item( 0, index ) : item( 1, index - size_[0] );
+    }
+
+    DATACLASS* front() const { return item( 0, 0 ); }
+    DATACLASS* back() const { return (*this)[size()-1]; }
+
+    iterator begin() const { return iterator( this, 0, 0 ); }
+    iterator end() const { return nsegments_==2 ? iterator( this, 1, size_[1] ) : iterator( this, 0, size_[0] ); }
+
+private:
+    char* begin_[2];
+    std::size_t size_[2];
+    std::size_t stride_;
+    unsigned int nsegments_;
+};
+
+#endif // dataview.hpp
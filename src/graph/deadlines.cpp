@@ -0,0 +1,231 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "deadlines.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "g3log/src/g2log.hpp"
+
+const std::string Deadlines::STATE_NAME = "behind_realtime";
+
+void Deadlines::Configure( const YAML::Node& node ) {
+    
+    // nothing carries over from an earlier graph
+    *this = Deadlines();
+    
+    if (!node) { return; }
+    
+    if (node.IsScalar()) {
+        enabled_ = node.as<bool>();
+    } else if (node.IsMap()) {
+        enabled_ = node["enabled"].as<bool>( true );
+        tolerance_ = node["tolerance"].as<double>( tolerance_ );
+        slack_ = node["slack"].as<double>( slack_ );
+        log_ = node["log"].as<bool>( log_ );
+        state_ = node["state"].as<bool>( state_ );
+        nworst_ = node["nworst"].as<unsigned int>( nworst_ );
+    } else {
+        throw std::runtime_error( "Invalid deadlines definition." );
+    }
+    
+    if (tolerance_<0) {
+        throw std::runtime_error( "Deadlines tolerance should be a positive number." );
+    }
+    if (slack_<=0) {
+        throw std::runtime_error( "Deadlines slack should be larger than zero." );
+    }
+}
+
+DeadlineMonitor::DeadlineMonitor( std::string name, double stream_rate, const Deadlines& settings, DeadlineFlag* flag,
+    std::function<bool()> input_pending ) :
+name_(name), period_ns_(1e9/stream_rate), tolerance_(settings.tolerance()), slack_ns_(settings.slack()*1e6),
+log_(settings.log()), nworst_(settings.nworst()), flag_(flag), input_pending_(input_pending),
+worst_published_(new OverrunRecord[settings.nworst()]) {
+    
+    worst_.reserve( nworst_ + 1 );
+}
+
+void DeadlineMonitor::Published( uint64_t nitems ) {
+    
+    TimePoint now = Clock::now();
+    double budget = nitems * period_ns_;
+    
+    if (claimed_!=TimePoint()) {
+        int64_t processing = std::chrono::duration_cast<std::chrono::nanoseconds>( now - claimed_ ).count();
+        processing_ns_.Record( processing );
+        if (processing > budget * (1.0 + tolerance_)) {
+            processing_overruns_.fetch_add( 1, std::memory_order_relaxed );
+        }
+        claimed_ = TimePoint();
+    }
+    
+    // sources always have work to do
+    bool pending = input_pending_ ? input_pending_() : true;
+    
+    // the first publication sets the reference
+    if (last_==TimePoint()) {
+        first_ = last_ = now;
+        nitems_ += nitems;
+        pending_ = pending;
+        return;
+    }
+    
+    int64_t interval = std::chrono::duration_cast<std::chrono::nanoseconds>( now - last_ ).count();
+    last_ = now;
+    
+    interval_ns_.Record( interval );
+    
+    // without pending input, (part of) the interval was spent waiting for upstream
+    if (pending_ && interval > budget * (1.0 + tolerance_)) {
+        overruns_.fetch_add( 1, std::memory_order_relaxed );
+        Overrun overrun{ nitems_, static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( now - first_ ).count() ),
+            static_cast<uint64_t>( interval ), static_cast<uint64_t>( budget ) };
+        if (nworst_>0 && (worst_.size() < nworst_ || overrun.excess() > worst_.back().excess())) {
+            RecordOverrun( overrun );
+        }
+    }
+    nitems_ += nitems;
+    
+    // a processor that has drained its input keeps up with real time
+    if (!pending) {
+        lag_ns_ = 0;
+    } else {
+        lag_ns_ = std::max( 0.0, lag_ns_ + interval - budget );
+    }
+    pending_ = pending;
+    
+    uint64_t lag = static_cast<uint64_t>( lag_ns_ );
+    lag_now_ns_.store( lag, std::memory_order_relaxed );
+    if (lag > max_lag_ns_.load( std::memory_order_relaxed )) {
+        max_lag_ns_.store( lag, std::memory_order_relaxed );
+    }
+    
+    if (!behind_ && lag_ns_ > slack_ns_) {
+        behind_ = true;
+        behind_count_.fetch_add( 1, std::memory_order_relaxed );
+        if (flag_) { flag_->Raise(); }
+        LOG_IF(UPDATE, log_) << name_ << " is falling behind real time (lag " << lag_ns_/1e6 << " ms after "
+            << nitems_ << " items).";
+    } else if (behind_ && lag_ns_ < 0.5 * slack_ns_) {
+        behind_ = false;
+        if (flag_) { flag_->Clear(); }
+        LOG_IF(UPDATE, log_) << name_ << " has caught up with real time.";
+    }
+}
+
+void DeadlineMonitor::OverrunRecord::store( const Overrun& overrun ) {
+    
+    item.store( overrun.item, std::memory_order_relaxed );
+    time_ns.store( overrun.time_ns, std::memory_order_relaxed );
+    interval_ns.store( overrun.interval_ns, std::memory_order_relaxed );
+    budget_ns.store( overrun.budget_ns, std::memory_order_relaxed );
+}
+
+DeadlineMonitor::Overrun DeadlineMonitor::OverrunRecord::load() const {
+    
+    return Overrun{ item.load( std::memory_order_relaxed ), time_ns.load( std::memory_order_relaxed ),
+        interval_ns.load( std::memory_order_relaxed ), budget_ns.load( std::memory_order_relaxed ) };
+}
+
+void DeadlineMonitor::RecordOverrun( const Overrun& overrun ) {
+    
+    auto it = std::find_if( worst_.begin(), worst_.end(),
+        [&overrun]( const Overrun& o ) { return overrun.excess() > o.excess(); } );
+    worst_.insert( it, overrun );
+    if (worst_.size() > nworst_) { worst_.pop_back(); }
+    
+    // single writer sequence lock: readers retry while the sequence is odd or changed
+    uint64_t sequence = worst_sequence_.load( std::memory_order_relaxed );
+    worst_sequence_.store( sequence + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    for (std::size_t k=0; k<worst_.size(); ++k) {
+        worst_published_[k].store( worst_[k] );
+    }
+    nworst_published_.store( worst_.size(), std::memory_order_relaxed );
+    worst_sequence_.store( sequence + 2, std::memory_order_release );
+}
+
+std::vector<DeadlineMonitor::Overrun> DeadlineMonitor::worst() const {
+    
+    std::vector<Overrun> result;
+    uint64_t before, after;
+    
+    do {
+        result.clear();
+        before = worst_sequence_.load( std::memory_order_acquire );
+        unsigned int n = std::min( nworst_published_.load( std::memory_order_relaxed ), nworst_ );
+        for (unsigned int k=0; k<n; ++k) {
+            result.push_back( worst_published_[k].load() );
+        }
+        std::atomic_thread_fence( std::memory_order_acquire );
+        after = worst_sequence_.load( std::memory_order_relaxed );
+    } while ((before & 1) || before!=after);
+    
+    return result;
+}
+
+void DeadlineMonitor::Reset() {
+    
+    claimed_ = first_ = last_ = TimePoint();
+    nitems_ = 0;
+    lag_ns_ = 0;
+    pending_ = false;
+    behind_ = false;
+    worst_.clear();
+    
+    interval_ns_.Reset();
+    processing_ns_.Reset();
+    overruns_.store( 0, std::memory_order_relaxed );
+    processing_overruns_.store( 0, std::memory_order_relaxed );
+    behind_count_.store( 0, std::memory_order_relaxed );
+    lag_now_ns_.store( 0, std::memory_order_relaxed );
+    max_lag_ns_.store( 0, std::memory_order_relaxed );
+    
+    // not running: no concurrent writer
+    nworst_published_.store( 0, std::memory_order_relaxed );
+}
+
+YAML::Node DeadlineMonitor::ExportYAML() const {
+    
+    YAML::Node node;
+    node["period_ns"] = period_ns_;
+    node["source"] = !input_pending_;
+    node["interval_ns"] = interval_ns_.ExportYAML();
+    node["processing_ns"] = processing_ns_.ExportYAML();
+    node["overruns"] = overruns_.load( std::memory_order_relaxed );
+    node["processing_overruns"] = processing_overruns_.load( std::memory_order_relaxed );
+    node["fell_behind"] = behind_count_.load( std::memory_order_relaxed );
+    node["lag_ns"] = lag_now_ns_.load( std::memory_order_relaxed );
+    node["max_lag_ns"] = max_lag_ns_.load( std::memory_order_relaxed );
+    
+    YAML::Node worst_node( YAML::NodeType::Sequence );
+    for (auto & overrun : worst()) {
+        YAML::Node entry;
+        entry["item"] = overrun.item;
+        entry["time"] = overrun.time_ns / 1e9;
+        entry["interval_ns"] = overrun.interval_ns;
+        entry["budget_ns"] = overrun.budget_ns;
+        worst_node.push_back( entry );
+    }
+    node["worst"] = worst_node;
+    
+    return node;
+}
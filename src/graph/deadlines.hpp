@@ -0,0 +1,198 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#ifndef DEADLINES_H
+#define DEADLINES_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "slotstats.hpp"
+#include "sharedstate.hpp"
+#include "utilities/time.hpp"
+
+#include "yaml-cpp/yaml.h"
+
+/* Deadlines: real-time monitoring derived from the stream rate
+ * 
+ * Enabled with the deadlines key in the graph definition, either as
+ * "deadlines: true" (all defaults) or as a map:
+ * 
+ *   deadlines:
+ *       tolerance: 0.5   # allowed excess of a publication interval over its budget (fraction)
+ *       slack: 20        # lag behind real time (ms) at which a processor falls behind
+ *       log: true        # log an update when a processor falls behind or catches up
+ *       state: false     # expose a behind_realtime <bool> shared state on every processor
+ *       nworst: 8        # number of worst overruns kept per output slot
+ * 
+ * A regular stream has to be published at its stream rate. For every output
+ * slot with a regular stream, each publication of n items is given a budget
+ * of n/stream_rate seconds. The interval since the previous publication that
+ * exceeds the budget by more than the tolerance is an overrun. The lag is the
+ * accumulated excess of the intervals over their budgets, which shrinks again
+ * when the processor catches up (but never drops below zero). A processor
+ * falls behind real time when the lag of one of its slots exceeds the slack,
+ * and has caught up when the lag is back below half the slack.
+ * 
+ * Only sources are held to the nominal stream rate. A processor with inputs
+ * can not publish faster than its input arrives, so its lag is relative to
+ * the availability of input: the lag is cleared on every publication after
+ * which no input is pending, and an interval only counts as an overrun if
+ * input was already pending at its start. Upstream stalls or drift of the
+ * source clock are thus not blamed on downstream processors that keep up
+ * with their input.
+ * 
+ * Independent of the intervals, the processing time of every publication
+ * (from the first claim to the publication) that exceeds the budget by more
+ * than the tolerance is a processing overrun, for sources and processors
+ * with inputs alike.
+ */
+class Deadlines {
+public:
+    void Configure( const YAML::Node& node );
+    
+    bool enabled() const { return enabled_; }
+    double tolerance() const { return tolerance_; }
+    double slack() const { return slack_; }
+    bool log() const { return log_; }
+    bool state() const { return state_; }
+    unsigned int nworst() const { return nworst_; }
+    
+    static const std::string STATE_NAME;
+    
+protected:
+    bool enabled_ = false;
+    double tolerance_ = 0.5;
+    double slack_ = 20.0; // ms
+    bool log_ = true;
+    bool state_ = false;
+    unsigned int nworst_ = 8;
+};
+
+// processor level flag, raised while any of its output slots is behind;
+// all slots of a processor are published from the same thread
+class DeadlineFlag {
+public:
+    DeadlineFlag( WritableState<bool>* state ) : state_(state) {}
+    
+    void Raise() { if (nbehind_++ == 0 && state_) { state_->set( true ); } }
+    void Clear() { if (--nbehind_ == 0 && state_) { state_->set( false ); } }
+    void Reset() { nbehind_ = 0; if (state_) { state_->set( false ); } }
+    
+protected:
+    WritableState<bool>* state_;
+    unsigned int nbehind_ = 0;
+};
+
+/* DeadlineMonitor: deadline statistics of a single output slot
+ * 
+ * Claimed and Published are called in the publishing thread. Statistics can
+ * be exported from any thread. The worst overruns are guarded by a sequence
+ * lock, such that the publishing thread never waits for an export.
+ */
+class DeadlineMonitor {
+public:
+    // input_pending: true if the processor has input waiting to be
+    // processed (empty for sources)
+    DeadlineMonitor( std::string name, double stream_rate, const Deadlines& settings, DeadlineFlag* flag,
+        std::function<bool()> input_pending = nullptr );
+    
+    DeadlineMonitor( const DeadlineMonitor& ) = delete;
+    DeadlineMonitor& operator=( const DeadlineMonitor& ) = delete;
+    
+    // processing time runs from the first claim to the publication
+    void Claimed() {
+        
+        if (claimed_==TimePoint()) { claimed_ = Clock::now(); }
+    }
+    void Published( uint64_t nitems );
+    
+    // before every run
+    void Reset();
+    
+    const std::string& name() const { return name_; }
+    uint64_t noverruns() const { return overruns_.load( std::memory_order_relaxed ); }
+    uint64_t nprocessing_overruns() const { return processing_overruns_.load( std::memory_order_relaxed ); }
+    uint64_t max_lag_ns() const { return max_lag_ns_.load( std::memory_order_relaxed ); }
+    
+    YAML::Node ExportYAML() const;
+    
+protected:
+    struct Overrun {
+        uint64_t item; // number of items published before the overrun
+        uint64_t time_ns; // since the first publication
+        uint64_t interval_ns;
+        uint64_t budget_ns;
+        
+        uint64_t excess() const { return interval_ns - budget_ns; }
+    };
+    
+    // relaxed atomic fields, written under the sequence lock
+    struct OverrunRecord {
+        std::atomic<uint64_t> item{0};
+        std::atomic<uint64_t> time_ns{0};
+        std::atomic<uint64_t> interval_ns{0};
+        std::atomic<uint64_t> budget_ns{0};
+        
+        void store( const Overrun& overrun );
+        Overrun load() const;
+    };
+    
+    void RecordOverrun( const Overrun& overrun );
+    std::vector<Overrun> worst() const;
+    
+protected:
+    std::string name_;
+    double period_ns_; // budget of a single item
+    double tolerance_;
+    double slack_ns_;
+    bool log_;
+    unsigned int nworst_;
+    DeadlineFlag* flag_;
+    std::function<bool()> input_pending_;
+    
+    // publishing thread only
+    TimePoint claimed_;
+    TimePoint first_;
+    TimePoint last_;
+    uint64_t nitems_ = 0;
+    double lag_ns_ = 0;
+    bool pending_ = false; // input was pending after the previous publication
+    bool behind_ = false;
+    std::vector<Overrun> worst_; // sorted by excess, largest first
+    
+    LogHistogram interval_ns_;
+    LogHistogram processing_ns_;
+    std::atomic<uint64_t> overruns_{0};
+    std::atomic<uint64_t> processing_overruns_{0};
+    std::atomic<uint64_t> behind_count_{0};
+    std::atomic<uint64_t> lag_now_ns_{0};
+    std::atomic<uint64_t> max_lag_ns_{0};
+    
+    // published copy of worst_: odd sequence while being written
+    std::atomic<uint64_t> worst_sequence_{0};
+    std::atomic<unsigned int> nworst_published_{0};
+    std::unique_ptr<OverrunRecord[]> worst_published_;
+};
+
+#endif // deadlines.hpp
@@ -18,6 +18,7 @@
 // ---------------------------------------------------------------------
 
 #include <unistd.h>
+#include <algorithm>
 #include <fstream>
 
 #include "graphmanager.hpp"
@@ -73,10 +74,17 @@ void GraphManager::HandleCommand( std::string command, std::deque<std::string>&
     } else if (command == "destroy") {
         graph_.Destroy();
     } else if (command == "start" || command == "test") {
+        // --offline may be given anywhere among the arguments
+        bool offline = false;
+        auto flag = std::find( extra.begin(), extra.end(), "--offline" );
+        if (flag!=extra.end()) {
+            extra.erase( flag );
+            offline = true;
+        }
         std::string run_env = extra.size()>0 ? extra[0] : "";
         std::string destination = extra.size()>1 ? extra[1] : "";
         std::string source = extra.size()>2 ? extra[2] : "";
-        graph_.StartProcessing( run_env, destination, source, command=="test" || global_context_->test() );
+        graph_.StartProcessing( run_env, destination, source, command=="test" || global_context_->test(), offline );
     } else if (command == "stop") {
         graph_.StopProcessing();
     } else if (command == "state") {
@@ -107,6 +115,32 @@ void GraphManager::HandleCommand( std::string command, std::deque<std::string>&
         }
     } else if (command == "yaml") {
         reply.push_back( graph_.ExportYAML() );
+    } else if (command == "placement") {
+        YAML::Emitter out;
+        out << graph_.cpu_placement();
+        reply.push_back( std::string( out.c_str() ) );
+    } else if (command == "stats") {
+        // graph stats [reset]
+        bool reset = extra.size()>0 && extra[0]=="reset";
+        YAML::Emitter out;
+        out << graph_.ExportSlotStats( reset );
+        reply.push_back( std::string( out.c_str() ) );
+    } else if (command == "realtime") {
+        YAML::Emitter out;
+        out << graph_.realtime_report();
+        reply.push_back( std::string( out.c_str() ) );
+    } else if (command == "ringsizing") {
+        YAML::Emitter out;
+        out << graph_.ring_sizing_report();
+        reply.push_back( std::string( out.c_str() ) );
+    } else if (command == "cpu") {
+        YAML::Emitter out;
+        out << graph_.ExportThreadUsage();
+        reply.push_back( std::string( out.c_str() ) );
+    } else if (command == "deadlines") {
+        YAML::Emitter out;
+        out << graph_.ExportDeadlines();
+        reply.push_back( std::string( out.c_str() ) );
     } else {
         throw std::runtime_error( "Unknown graph command \"" + command + "\"." );
     }
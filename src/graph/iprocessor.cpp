@@ -18,6 +18,7 @@
 // ---------------------------------------------------------------------
 
 #include "iprocessor.hpp"
+#include <algorithm>
 #include <regex>
 #include <iostream>
 #include <fstream>
@@ -154,6 +155,27 @@ void IProcessor::CompleteStreamInfo() {
     }
 }
 
+void IProcessor::AutoSizeRingBuffers( const RingSizing& sizing ) {
+    
+    for (auto& it : output_ports_ ) {
+        if (it.second->policy().fixed_buffer_size() || it.second->number_of_slots()==0) { continue; }
+        
+        // all slots of a port share the port policy, so size for the fastest stream
+        double rate = IRREGULARSTREAM;
+        for (SlotType k=0; k<it.second->number_of_slots(); ++k) {
+            rate = std::max( rate, it.second->slot(k)->streaminfo().stream_rate() );
+        }
+        
+        int size = sizing.size_for_rate( rate );
+        if (size==0) {
+            LOG(INFO) << "Kept ringbuffer size " << it.second->policy().buffer_size() << " for port " << name() << "." << it.first << " (irregular stream).";
+        } else {
+            it.second->set_buffer_size( size );
+            LOG(INFO) << "Set ringbuffer size to " << size << " for port " << name() << "." << it.first << " (" << rate << " items/s, " << sizing.max_stall() << " ms).";
+        }
+    }
+}
+
 void IProcessor::CreateRingBuffers() {
     
     for (auto& it : output_ports_ ) {
@@ -161,6 +183,27 @@ void IProcessor::CreateRingBuffers() {
     }
 }
 
+uint64_t IProcessor::item_count() {
+    
+    int64_t n = 0;
+    
+    if (n_input_ports()>0) {
+        for (auto& it : input_ports_ ) {
+            for ( int k=0; k<it.second->number_of_slots(); ++k ) {
+                n += it.second->slot(k)->nitems_released();
+            }
+        }
+    } else {
+        for (auto& it : output_ports_ ) {
+            for ( int k=0; k<it.second->number_of_slots(); ++k ) {
+                n += it.second->slot(k)->nitems_published();
+            }
+        }
+    }
+    
+    return n>0 ? n : 0;
+}
+
 void IProcessor::PrepareProcessing() {
     
     for (auto& it : input_ports_ ) {
@@ -183,6 +226,41 @@ void IProcessor::Alert() {
     }
 }
 
+void IProcessor::RecloseOutputs() {
+    
+    for (auto& it : output_ports_ ) {
+        for (SlotType k=0; k<it.second->number_of_slots(); ++k) {
+            it.second->slot(k)->Reclose();
+        }
+    }
+}
+
+StepResult IProcessor::ProcessStep( ProcessingContext& context ) {
+    
+    throw ProcessingError( "Step-wise processing is not supported.", name() );
+}
+
+bool IProcessor::ReadyForStep() const {
+    
+    // a step may block when claiming data on a full output slot
+    for (auto& it : output_ports_ ) {
+        for (SlotType k=0; k<it.second->number_of_slots(); ++k) {
+            if (!it.second->slot(k)->HasCapacity()) { return false; }
+        }
+    }
+    
+    // ready if any connected input slot has data
+    bool connected = false;
+    for (auto& it : input_ports_ ) {
+        for (SlotType k=0; k<it.second->number_of_slots(); ++k) {
+            if (!it.second->slot(k)->connected()) { continue; }
+            if (it.second->slot(k)->DataAvailable()) { return true; }
+            connected = true;
+        }
+    }
+    
+    return !connected;
+}
 
 bool IProcessor::UpdateState( std::string state, std::string value ) {
     
@@ -246,7 +324,11 @@ YAML::Node IProcessor::ExportYAML() {
     return node;
 }
 
-void IProcessor::CreatePortsInternal( std::map<std::string, int> & buffer_sizes ) {
+void IProcessor::CreatePortsInternal( std::map<std::string, int> & buffer_sizes,
+    std::map<std::string,std::pair<WaitStrategy,WaitParameters>> & wait_strategies,
+    std::map<std::string,ItemAllocation> & ring_allocations,
+    std::set<std::string> & multi_producer_ports,
+    std::set<std::string> & lossy_ports ) {
     
     CreatePorts();
     // set requested buffer sizes
@@ -254,8 +336,47 @@ void IProcessor::CreatePortsInternal( std::map<std::string, int> & buffer_sizes
         if (!has_output_port( it.first ) || it.second<2) {
             LOG(WARNING) << "Could not set ringbuffer size to " << it.second << " for port " << name() << "." << it.first;
         } else {
-            output_port( it.first )->set_buffer_size( it.second );
+            output_port( it.first )->set_buffer_size( it.second, true );
             LOG(INFO) << "Set ringbuffer size to " << it.second << " for port " << name() << "." << it.first;
         }
     }
+    // set requested wait strategies
+    for ( auto & it : wait_strategies ) {
+        if (!has_output_port( it.first )) {
+            LOG(WARNING) << "Could not set wait strategy to " << wait_strategy_to_string( it.second.first ) << " for port " << name() << "." << it.first;
+        } else {
+            output_port( it.first )->set_wait_strategy( it.second.first, it.second.second );
+            LOG(INFO) << "Set wait strategy to " << wait_strategy_to_string( it.second.first ) << " for port " << name() << "." << it.first;
+        }
+    }
+    // set requested ring buffer item allocation
+    for ( auto & it : ring_allocations ) {
+        if (!has_output_port( it.first )) {
+            LOG(WARNING) << "Could not set ring allocation to " << item_allocation_to_string( it.second ) << " for port " << name() << "." << it.first;
+        } else {
+            output_port( it.first )->set_item_allocation( it.second );
+            LOG(INFO) << "Set ring allocation to " << item_allocation_to_string( it.second ) << " for port " << name() << "." << it.first;
+        }
+    }
+    // enable multiple producers
+    for ( auto & it : multi_producer_ports ) {
+        if (!has_output_port( it )) {
+            LOG(WARNING) << "Could not enable multiple producers for port " << name() << "." << it;
+        } else {
+            output_port( it )->set_multi_producer( true );
+            LOG(INFO) << "Enabled multiple producers for port " << name() << "." << it;
+        }
+    }
+    // make input ports lossy
+    for ( auto & it : lossy_ports ) {
+        if (!has_input_port( it ) || input_port( it )->policy().cache_enabled()) {
+            LOG(WARNING) << "Could not make input port " << name() << "." << it << " lossy.";
+        } else if (!input_port( it )->lossy_compatible()) {
+            LOG(WARNING) << "Could not make input port " << name() << "." << it <<
+                " lossy: data type " << input_port( it )->datatype().name() << " has no fixed-size payload.";
+        } else {
+            input_port( it )->set_lossy( true );
+            LOG(INFO) << "Made input port " << name() << "." << it << " lossy.";
+        }
+    }
 }
@@ -27,6 +27,7 @@
 #include "threadutilities.hpp"
 #include "runinfo.hpp"
 #include "portpolicy.hpp"
+#include "ringsizing.hpp"
 
 #include "streamports.hpp"
 
@@ -37,6 +38,7 @@
 
 #include <functional>
 #include "sharedstate.hpp"
+#include "snapshotstate.hpp"
 
 // exception class for all processor related errors
 GRAPHERROR( ProcessorInternalError );
@@ -49,6 +51,9 @@ GRAPHERROR( ProcessingPreprocessingError );
 
 bool is_valid_name( std::string s );
 
+// outcome of a single call to IProcessor::ProcessStep
+enum class StepResult { IDLE, BUSY, DONE };
+
 //forward declaration
 class ProcessorEngine;
 
@@ -101,15 +106,30 @@ public:
     virtual bool isfilter() const { return (!issource() && !issink()); }
     virtual bool isautonomous() const { return (issource() && issink()); }
         
+    // items released from all input slots (sources: items published on all output slots)
+    uint64_t item_count();
+    
     IPortIn* input_port( std::string port ) { return input_ports_.at(port).get(); }
     IPortOut* output_port( std::string port ) { return output_ports_.at(port).get(); }
     
     virtual void Preprocess( ProcessingContext& context ) {};
     virtual void Process( ProcessingContext& context ) = 0;
     virtual void Postprocess( ProcessingContext& context ) {};
+    
+    // step-wise processing for processors that share a thread with other
+    // processors (see ThreadGroup). ProcessStep should only consume the
+    // data that is available and return without blocking: IDLE if nothing
+    // was done, BUSY if data was processed and DONE if processing finished.
+    virtual bool steppable() const { return false; }
+    virtual StepResult ProcessStep( ProcessingContext& context );
+    virtual bool ReadyForStep() const;
     virtual void CompleteStreamInfo();
     virtual void Prepare( GlobalContext& context ) {};
     virtual void Unprepare( GlobalContext& context ) {};
+    // Prepare, Unprepare and CreateRingBuffers of different processors run
+    // concurrently, unless a processor opts out (e.g. because it accesses a
+    // device library that is not thread-safe)
+    virtual bool parallel_prepare() const { return true; }
     
     virtual void TestPrepare( ProcessingContext& context ) {};
     virtual void TestFinalize( ProcessingContext& context ) {};
@@ -140,6 +160,30 @@ public:
         return ((WritableState<T>*) shared_states_[state].get());
     }
     
+    template <typename T>
+    ReadableSnapshotState<T>* create_readable_snapshot_state( std::string state, Permission peers = Permission::WRITE, Permission external = Permission::NONE ) {
+        if (shared_states_.count( state)==1 || !is_valid_name(state)) {
+            throw ProcessorInternalError( "Shared state \"" + state + "\" is invalid or already exists.", name() );
+        }
+        
+        shared_states_[state] = std::move( std::unique_ptr<IState>( (IState*) new ReadableSnapshotState<T>( peers, external ) ) );
+        
+        return ((ReadableSnapshotState<T>*) shared_states_[state].get());
+    }
+    
+    template <typename T>
+    WritableSnapshotState<T>* create_writable_snapshot_state( std::string state, Permission peers = Permission::READ, Permission external = Permission::NONE ) {
+        if (shared_states_.count( state)==1 || !is_valid_name(state)) {
+            throw ProcessorInternalError( "Shared state \"" + state + "\" is invalid or already exists.", name() );
+        }
+        
+        shared_states_[state] = std::move( std::unique_ptr<IState>( (IState*) new WritableSnapshotState<T>( peers, external ) ) );
+        
+        return ((WritableSnapshotState<T>*) shared_states_[state].get());
+    }
+    
+    bool has_shared_state( std::string state ) { return shared_states_.count( state )==1; }
+    
     IState* shared_state(std::string state) {
         if (this->shared_states_.count(state)==0) {
             throw ProcessorInternalError( "Shared state \"" + state + "\" does not exist.", name() );
@@ -168,7 +212,11 @@ private:    // called by ProcessorEngine
     bool UpdateState( std::string state, std::string value );
     std::string RetrieveState( std::string state );
     YAML::Node ApplyMethod( std::string name, const YAML::Node& node );
-    void CreatePortsInternal( std::map<std::string,int> & buffer_sizes );
+    void CreatePortsInternal( std::map<std::string,int> & buffer_sizes,
+        std::map<std::string,std::pair<WaitStrategy,WaitParameters>> & wait_strategies,
+        std::map<std::string,ItemAllocation> & ring_allocations,
+        std::set<std::string> & multi_producer_ports,
+        std::set<std::string> & lossy_ports );
   
       
 protected:
@@ -194,9 +242,11 @@ protected:
     
 private:
     void NegotiateConnections();
+    void AutoSizeRingBuffers( const RingSizing& sizing );
     void CreateRingBuffers();
     void PrepareProcessing();
     void Alert();
+    void RecloseOutputs();
     
 private:
     void set_name( std::string name ) { name_ = name; }
@@ -18,6 +18,11 @@
 // ---------------------------------------------------------------------
 
 #include "istreamports.hpp"
+#include "ringbuffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
 
 void ISlotOut::Connect( StreamInConnector* downstream ) {
     
@@ -29,11 +34,55 @@ void ISlotOut::Connect( StreamInConnector* downstream ) {
     }
 }
 
+void ISlotOut::Disconnect( StreamInConnector* downstream ) {
+    
+    downstream_slots_.erase( (ISlotIn*) downstream->slot() );
+}
+
+void ISlotOut::RemoveNotifier( PortNotifier* notifier ) {
+    
+    notifiers_.erase( std::remove( notifiers_.begin(), notifiers_.end(), notifier ), notifiers_.end() );
+}
+
+void ISlotOut::AddCoProducer( ISlotOut* producer ) {
+    
+    if (producer==this || producer->owner_==this) { return; }
+    
+    if (owner_!=nullptr) {
+        owner_->AddCoProducer( producer );
+        return;
+    }
+    
+    if (producer->shared()) {
+        throw std::runtime_error( "Output slot already shares a ring buffer with other producers." );
+    }
+    
+    producer->owner_ = this;
+    co_producers_.push_back( producer );
+}
+
+bool ISlotOut::ReleaseProducer() {
+    
+    // every producer releases once per run
+    if (unlocked_.exchange( true )) { return false; }
+    // (a slot that was never prepared is closed right away)
+    return owner()->open_producers_.fetch_sub( 1 )<=1;
+}
+
+void ISlotOut::ResetProducers() {
+    
+    unlocked_.store( false );
+    if (owner_==nullptr) {
+        open_producers_.store( 1 + co_producers_.size() );
+    }
+}
+
 std::vector<RingSequence*> ISlotOut::gating_sequences() {
     
+    // lossy slots never hold back the producer
     std::vector<RingSequence*> v;
     for (auto & it : downstream_slots_ ) {
-        v.push_back( it->sequence() );
+        if (!it->lossy()) { v.push_back( it->sequence() ); }
     }
     return v;
 }
@@ -42,7 +91,17 @@ void ISlotIn::ReleaseData() {
     
     if (nretrieved_>0) {
         
+        // the producer may have lapped a lossy slot while the data was in use
+        if (lossy_) {
+            int64_t cursor = upstream_->cursor();
+            int64_t lapped = cursor - sequence_.sequence() - upstream_->buffer_size();
+            if (cursor!=INT64_MAX && lapped>0) {
+                stats_.overwritten.fetch_add( std::min( lapped, nretrieved_ ), std::memory_order_relaxed );
+            }
+        }
+        
         int64_t value = sequence_.IncrementAndGet( nretrieved_ );
+        nreleased_.fetch_add( nretrieved_, std::memory_order_relaxed );
         nretrieved_ = 0;
         
         if (value+1<0) {sequence_.set_sequence( INT64_MAX );}
@@ -50,9 +109,78 @@ void ISlotIn::ReleaseData() {
     }
 }
 
+bool ISlotIn::DataAvailable( uint64_t n ) const {
+    
+    if (!connected()) { return true; }
+    
+    int64_t current_sequence = sequence_.sequence();
+    if (current_sequence==INT64_MAX) { return true; }
+    
+    int64_t available_sequence = upstream_->cursor();
+    return available_sequence==INT64_MAX || available_sequence >= current_sequence + ncached_ + (int64_t) n;
+}
+
+int64_t ISlotIn::timed_wait( int64_t sequence ) {
+    
+    TimePoint start = Clock::now();
+    int64_t available_sequence = upstream_->WaitFor( sequence );
+    wait_end_ = Clock::now();
+    stats_.wait_ns.Record( std::chrono::duration_cast<std::chrono::nanoseconds>( wait_end_ - start ).count() );
+    return available_sequence;
+}
+
+int64_t ISlotIn::timed_wait( int64_t sequence, int64_t time_out ) {
+    
+    TimePoint start = Clock::now();
+    int64_t available_sequence = upstream_->WaitFor( sequence, time_out );
+    wait_end_ = Clock::now();
+    // a poll (zero time out) that finds no data did not wait for data
+    if (time_out!=0 || available_sequence>=sequence) {
+        stats_.wait_ns.Record( std::chrono::duration_cast<std::chrono::nanoseconds>( wait_end_ - start ).count() );
+    }
+    return available_sequence;
+}
+
+void ISlotIn::record_retrieval( int64_t first_sequence, int64_t available_sequence, const IData* oldest ) {
+    
+    uint64_t backlog = available_sequence - first_sequence + 1;
+    stats_.backlog.Record( backlog );
+    // only the processing thread updates the peak
+    if (backlog > peak_backlog_.load( std::memory_order_relaxed )) {
+        peak_backlog_.store( backlog, std::memory_order_relaxed );
+    }
+    
+    // items without source timestamp have no meaningful age
+    if (oldest!=nullptr && oldest->source_timestamp()!=TimePoint()) {
+        auto age = std::chrono::duration_cast<std::chrono::nanoseconds>( wait_end_ - oldest->source_timestamp() ).count();
+        stats_.age_ns.Record( age<0 ? 0 : age );
+    }
+}
+
+int64_t ISlotIn::skip_overrun( int64_t first_sequence, int64_t available_sequence, int64_t n ) {
+    
+    if (!lossy_ || available_sequence - first_sequence + 1 <= LOSSY_SKIP_LEVEL*upstream_->buffer_size()) {
+        return first_sequence;
+    }
+    
+    int64_t skipped = available_sequence - n + 1 - first_sequence;
+    if (skipped<=0) { return first_sequence; }
+    
+    sequence_.set_sequence( sequence_.sequence() + skipped );
+    stats_.dropped.fetch_add( skipped, std::memory_order_relaxed );
+    
+    return first_sequence + skipped;
+}
+
 void ISlotIn::Connect( StreamOutConnector* upstream ) {
     
     if (connected()) {
+        // multiple multi-producer slots can feed into a single input slot
+        if (upstream_connector_->port()->policy().multi_producer() &&
+            upstream->port()->policy().multi_producer()) {
+            upstream_->AddCoProducer( upstream->slot() );
+            return;
+        }
         throw std::runtime_error( "Error connecting to slot (already connected)" );
     }
 
@@ -60,12 +188,38 @@ void ISlotIn::Connect( StreamOutConnector* upstream ) {
     upstream_ = (ISlotOut*) upstream->slot();
 }
 
+void ISlotIn::Disconnect() {
+    
+    upstream_connector_ = nullptr;
+    upstream_ = nullptr;
+}
+
+std::string ISlotIn::UpstreamSignature() const {
+    
+    if (!connected()) { return ""; }
+    
+    // emitted in a fixed order (yaml-cpp does not keep the order of map keys)
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "stream_rate" << YAML::Value << upstream_->streaminfo().stream_rate();
+    const IData* item = upstream_->DataAt( 0 );
+    if (item!=nullptr) {
+        YAML::Node description;
+        item->YAMLDescription( description, Serialization::Format::FULL );
+        out << YAML::Key << "item" << YAML::Value << description;
+    }
+    out << YAML::EndMap;
+    return out.c_str();
+}
+
 void ISlotIn::PrepareProcessing() {
     
     sequence_.set_sequence(-1L);
     ncached_ = 0;
     cache_ = nullptr;
     nretrieved_ = 0;
+    nreleased_.store( 0, std::memory_order_relaxed );
+    peak_backlog_.store( 0, std::memory_order_relaxed );
 }
 
 YAML::Node IPortOut::ExportYAML() const {
@@ -74,19 +228,42 @@ YAML::Node IPortOut::ExportYAML() const {
     node["nslots_min"] = policy().min_slot_number();
     node["nslots_max"] = policy().max_slot_number();
     node["buffer_size"] = policy().buffer_size();
-    if (policy().wait_strategy()==WaitStrategy::kBlockingStrategy) {
-        node["wait_strategy"] = "blocking";
-    } else if (policy().wait_strategy()==WaitStrategy::kSleepingStrategy) {
-        node["wait_strategy"] = "sleeping";
-    } else if (policy().wait_strategy()==WaitStrategy::kYieldingStrategy) {
-        node["wait_strategy"] = "yielding";
-    } else {
-        node["wait_strategy"] = "busy spin";
+    node["wait_strategy"] = wait_strategy_to_string( policy().wait_strategy() );
+    if (policy().wait_strategy()==WaitStrategy::kHybridStrategy) {
+        node["wait_spin_tries"] = policy().wait_parameters().spin_tries;
+        node["wait_yield_tries"] = policy().wait_parameters().yield_tries;
     }
+    node["ring_allocation"] = item_allocation_to_string( policy().item_allocation() );
+    node["multi_producer"] = policy().multi_producer();
     return node;
     
 }
 
+void IPortIn::set_lossy( bool value ) {
+    
+    if (value && policy_.cache_enabled()) {
+        throw std::runtime_error( "Cached input port " + name() + " cannot be lossy." );
+    }
+    
+    if (value && !lossy_compatible()) {
+        throw std::runtime_error( "Input port " + name() + " cannot be lossy: data type " +
+            datatype().name() + " has no fixed-size payload." );
+    }
+    
+    policy_.set_lossy( value );
+    for (SlotType k=0; k<number_of_slots(); ++k) {
+        slot(k)->lossy_ = value;
+    }
+}
+
+void IPortIn::Disconnect( int slot, StreamOutConnector* upstream ) {
+    
+    if (wait_any_) {
+        upstream->slot()->RemoveNotifier( &notifier_ );
+    }
+    this->slot( slot )->Disconnect();
+}
+
 YAML::Node IPortIn::ExportYAML() const {
     YAML::Node node;
     node["datatype"] = datatype().name();
@@ -94,5 +271,123 @@ YAML::Node IPortIn::ExportYAML() const {
     node["nslots_max"] = policy().max_slot_number();
     node["cache"] = policy().cache_enabled();
     node["time_out"] = policy().time_out();
+    node["lossy"] = policy().lossy();
     return node;
 }
+
+void PublishGroup::Add( ISlotOut* slot ) {
+    
+    slots_.push_back( slot );
+    published_.resize( slots_.size() );
+    
+    for (auto & notifier : slot->notifiers()) {
+        if (std::find( notifiers_.begin(), notifiers_.end(), notifier )==notifiers_.end()) {
+            notifiers_.push_back( notifier );
+        }
+    }
+}
+
+void PublishGroup::Add( IPortOut* port ) {
+    
+    for (SlotType k=0; k<port->number_of_slots(); ++k) {
+        Add( port->slot(k) );
+    }
+}
+
+bool PublishGroup::HasCapacity() const {
+    
+    for (auto & slot : slots_) {
+        if (!slot->HasCapacity()) { return false; }
+    }
+    return true;
+}
+
+void PublishGroup::Publish() {
+    
+    std::size_t n = 0;
+    for (auto & slot : slots_) {
+        if (slot->PublishWithoutSignal()) { published_[n++] = slot; }
+    }
+    
+    if (n==0) { return; }
+    
+    // order all cursor updates before the checks for waiting consumers
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    
+    for (std::size_t k=0; k<n; ++k) {
+        published_[k]->SignalPublished();
+    }
+    
+    for (auto & notifier : notifiers_) {
+        notifier->Notify();
+    }
+}
+
+void PortNotifier::Notify() {
+    
+    // the publication precedes the waiter check; paired with the fence in
+    // AddWaiter, either a consumer sees the publication when it checks the
+    // slots, or the waiter is seen here and the word changes under it
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if (waiters_.load( std::memory_order_relaxed )>0) {
+        word_.fetch_add( 1, std::memory_order_release );
+        disruptor::FutexWakeAll( &word_ );
+    }
+}
+
+void PortNotifier::AddWaiter() {
+    
+    waiters_.fetch_add( 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+}
+
+void PortNotifier::Wait( uint32_t epoch, int64_t timeout_micros ) {
+    
+    // a notification after the epoch was read changes the word, such that the
+    // kernel does not put the thread to sleep
+    disruptor::FutexWait( &word_, epoch, timeout_micros );
+}
+
+int IPortIn::WaitAny( TimePoint deadline ) {
+    
+    if (!wait_any_) {
+        throw std::runtime_error( "WaitAny is not enabled for input port " + name_ + "." );
+    }
+    
+    SlotType nslots = number_of_slots();
+    
+    // producers only bump the notification word while a consumer is registered
+    notifier_.AddWaiter();
+    
+    while (true) {
+        
+        // read the epoch before checking the slots, so that any publication
+        // after the check wakes us up
+        uint32_t epoch = notifier_.epoch();
+        
+        for (SlotType k=0; k<nslots; ++k) {
+            SlotType index = (next_slot_ + k) % nslots;
+            ISlotIn* s = slot( index );
+            if (s->connected() && s->DataAvailable()) {
+                next_slot_ = (index + 1) % nslots;
+                notifier_.RemoveWaiter();
+                return index;
+            }
+        }
+        
+        int64_t timeout_micros = -1;
+        if (deadline!=TimePoint::max()) {
+            TimePoint now = Clock::now();
+            if (now>=deadline) { notifier_.RemoveWaiter(); return -1; }
+            timeout_micros = std::chrono::duration_cast<std::chrono::microseconds>( deadline - now ).count() + 1;
+        }
+        
+        notifier_.Wait( epoch, timeout_micros );
+    }
+}
+
+int IPortIn::WaitAny( int64_t time_out_micros ) {
+    
+    if (time_out_micros<0) { return WaitAny( TimePoint::max() ); }
+    return WaitAny( Clock::now() + std::chrono::microseconds( time_out_micros ) );
+}
@@ -23,13 +23,46 @@
 #include "portpolicy.hpp"
 #include "../data/idata.hpp"
 #include "connections.hpp"
+#include "slotstats.hpp"
+#include "deadlines.hpp"
 
 #include "yaml-cpp/yaml.h"
 
+#include <atomic>
+#include <functional>
+#include <vector>
+
 //forward declarations
 //class StreamInConnector;
 //class StreamOutConnector;
 
+/* PortNotifier: notification word shared by all input slots of a port
+ * 
+ * A consumer registers as waiter before it checks the slots of the port,
+ * and can then sleep on a single futex until any of the slots has data (see
+ * IPortIn::WaitAny). The upstream slots call Notify after every publication
+ * and when they close; the word is only bumped, and a wake-up system call
+ * only made, while a consumer is registered.
+ */
+class PortNotifier {
+public:
+    void Notify();
+    
+    // register/unregister the calling consumer, a registered consumer must
+    // read the epoch before every check of the slots
+    void AddWaiter();
+    void RemoveWaiter() { waiters_.fetch_sub( 1, std::memory_order_relaxed ); }
+    
+    uint32_t epoch() const { return word_.load( std::memory_order_acquire ); }
+    
+    // sleep as long as the word equals epoch, for at most timeout_micros (negative: no time out)
+    void Wait( uint32_t epoch, int64_t timeout_micros );
+    
+protected:
+    std::atomic<uint32_t> word_{0};
+    std::atomic<int> waiters_{0};
+};
+
 class ISlotOut {
 
 friend class ISlotIn;
@@ -49,18 +82,92 @@ public:
     
     int buffer_size() const { return buffer_size_; }
     
+    // true if an item can be claimed without waiting for downstream slots
+    virtual bool HasCapacity() const = 0;
+    
+    // touch all memory of the ring buffer, returns the number of pages
+    virtual std::size_t Prefault() = 0;
+    
+    // split publication (see PublishGroup): publish claimed data without
+    // waking up consumers, returns true if data was published; after a
+    // sequentially consistent fence, SignalPublished wakes up consumers that
+    // wait on the ring buffer and calls the publish hooks (the notifiers are
+    // left to the caller)
+    virtual bool PublishWithoutSignal() = 0;
+    virtual void SignalPublished() = 0;
+    
+    // called by the producing thread after its last publication: a single
+    // producer publishes with a plain cursor update, which may have reopened
+    // a cursor that was closed from another thread (e.g. when stopping)
+    virtual void Reclose() = 0;
+    
+    // re-read the gating sequences of the downstream slots, after a rebuilt
+    // consumer was connected to an existing ring buffer
+    virtual void UpdateGatingSequences() = 0;
+    
+    // hooks are called in the publishing thread after every publication
+    void AddPublishHook( std::function<void()> hook ) { publish_hooks_.push_back( hook ); }
+    // notifiers are bumped after every publication and when the slot closes
+    void AddNotifier( PortNotifier* notifier ) { notifiers_.push_back( notifier ); }
+    void RemoveNotifier( PortNotifier* notifier );
+    const std::vector<PortNotifier*>& notifiers() const { return notifiers_; }
+    
+    // NUMA node for the ring buffer arena (-1: no binding)
+    int numa_node() const { return numa_node_; }
+    void set_numa_node( int node ) { numa_node_ = node; }
+    
+    // multi-producer slots: the owner creates the ring buffer, which is
+    // shared by all co-producers
+    bool shared() const { return owner_!=nullptr || co_producers_.size()>0; }
+    ISlotOut* owner() { return owner_==nullptr ? this : owner_; }
+    
+    // latency tracing: identifier stamped on published items and, for
+    // source slots, the interval at which new traces are started (0: never)
+    void set_tracing( uint32_t hop, uint64_t interval ) { trace_hop_ = hop; trace_interval_ = interval; trace_count_ = 0; }
+    
+    // number of items published by this slot in the current run (counted
+    // separately, since the cursor is set to INT64_MAX when the slot closes)
+    int64_t nitems_published() const { return npublished_.load( std::memory_order_relaxed ); }
+    
+    // deadline monitoring of regular streams (nullptr: disabled)
+    void set_deadline_monitor( DeadlineMonitor* monitor ) { deadline_monitor_ = monitor; }
+    DeadlineMonitor* deadline_monitor() { return deadline_monitor_; }
+    
 protected:
 	// called by IPortOut
 	void Connect( StreamInConnector* downstream );
+	void Disconnect( StreamInConnector* downstream );
+	
+	// called by ISlotIn when a second multi-producer slot connects
+	void AddCoProducer( ISlotOut* producer );
+	
+	// called when a producer unlocks, returns true for the last producer
+	bool ReleaseProducer();
+	void ResetProducers();
 
 	// called by SlotIn
     int64_t WaitFor( int64_t sequence ) const { return barrier_->WaitFor( sequence ); }
     int64_t WaitFor( int64_t sequence, int64_t time_out ) const { return barrier_->WaitFor( sequence, time_out ); }
+    int64_t cursor() const { return barrier_->GetCursor(); }
 	
     virtual IData* DataAt( int64_t sequence ) const = 0;
     
+    // first item in ring buffer and distance in bytes between consecutive items
+    IData* ring_data() const { return ring_data_; }
+    std::size_t ring_stride() const { return ring_stride_; }
     
 	std::vector<RingSequence*> gating_sequences();
+	
+	// called for every claimed item
+	void start_trace( IData* data ) {
+	    
+	    if (trace_interval_>0 && ++trace_count_>=trace_interval_) {
+	        trace_count_ = 0;
+	        data->StartTrace( trace_hop_ );
+	    } else {
+	        data->ClearTrace();
+	    }
+	}
 
     
 protected:
@@ -72,6 +179,27 @@ protected:
 	std::unique_ptr< RingBarrier > barrier_ = nullptr;
 	
     int buffer_size_;
+    
+    IData* ring_data_ = nullptr;
+    std::size_t ring_stride_ = 0;
+    
+    std::vector<std::function<void()>> publish_hooks_;
+    std::vector<PortNotifier*> notifiers_;
+    
+    int numa_node_ = -1;
+    
+    ISlotOut* owner_ = nullptr;
+    std::vector<ISlotOut*> co_producers_;
+    std::atomic<int> open_producers_{0};
+    std::atomic<bool> unlocked_{false};
+    
+    uint32_t trace_hop_ = 0;
+    uint64_t trace_interval_ = 0;
+    uint64_t trace_count_ = 0;
+    
+    DeadlineMonitor* deadline_monitor_ = nullptr;
+    
+    std::atomic<int64_t> npublished_{0};
 };
 
 class IPortOut {
@@ -93,9 +221,14 @@ public:
     
     std::string name() const { return name_; }
     
+    void set_multi_producer( bool value ) {
+        policy_.set_multi_producer( value );
+    }
+    
 protected:
     //called by StreamOutConnector
     virtual void Connect( int slot, StreamInConnector* downstream ) = 0;
+    void Disconnect( int slot, StreamInConnector* downstream ) { this->slot( slot )->Disconnect( downstream ); }
     virtual int ReserveSlot( int slot ) = 0;
     
     virtual void CreateRingBuffers() = 0;
@@ -105,8 +238,17 @@ protected:
     
     virtual void NewSlot( int n=1 ) = 0;
     
-    void set_buffer_size( int sz ) {
+    void set_buffer_size( int sz, bool fixed = false ) {
         policy_.set_buffer_size( sz );
+        if (fixed) { policy_.set_fixed_buffer_size( true ); }
+    }
+    
+    void set_wait_strategy( WaitStrategy wait, WaitParameters wait_parameters ) {
+        policy_.set_wait_strategy( wait, wait_parameters );
+    }
+    
+    void set_item_allocation( ItemAllocation allocation ) {
+        policy_.set_item_allocation( allocation );
     }
     
 private:
@@ -124,12 +266,17 @@ friend class PortIn;
 friend class ISlotOut;
 
 public:
-    ISlotIn( int64_t time_out = -1, bool cache = false) : time_out_(time_out), cache_enabled_(cache) {}
+    ISlotIn( int64_t time_out = -1, bool cache = false, bool lossy = false ) :
+    time_out_(time_out), cache_enabled_(cache), lossy_(lossy) {}
     
     bool connected() const { return upstream_!=nullptr; };
     
 	void ReleaseData();
     
+    // true if n items can be retrieved without waiting (or if retrieval
+    // would return immediately, e.g. because the upstream slot has finished)
+    bool DataAvailable( uint64_t n = 1 ) const;
+    
     const SlotAddress& upstream_address() { 
         
         if (upstream_connector_ == nullptr) {
@@ -146,20 +293,70 @@ public:
         return upstream_connector_->port()->policy();
     }
     
+    // histograms of backlog, wait time and item age at retrieval
+    // (safe to read and reset from other threads)
+    const SlotStats& stats() const { return stats_; }
+    void ResetStats() { stats_.Reset(); }
+    
+    // largest backlog at retrieval in the current run (the statistics cover
+    // all runs since they were last reset)
+    uint64_t peak_backlog() const { return peak_backlog_.load( std::memory_order_relaxed ); }
+    
+    // number of items released by the processor in the current run (counted
+    // separately, since the sequence is set to INT64_MAX when the slot is alerted)
+    int64_t nitems_released() const { return nreleased_.load( std::memory_order_relaxed ); }
+    
+    bool lossy() const { return lossy_; }
+    
+    // end the stream on this slot, after all data has been released (used for
+    // fused processors, whose upstream slot is not closed when the upstream
+    // processor finishes)
+    void Close() { sequence_.set_sequence( INT64_MAX ); }
+    
+    // rate and item layout of the upstream stream, used to check that a
+    // rebuilt upstream processor produces the same stream as before
+    std::string UpstreamSignature() const;
+    
+    // fold the paths of traced items into the slot statistics
+    void set_fold_traces( bool value ) { fold_traces_ = value; }
+    
 protected:
 	// called by upstream ISlotOut
 	RingSequence* sequence() { return &sequence_; }
 	
 	//called by IPortIn
     void Connect( StreamOutConnector* upstream );
+    void Disconnect();
 	void PrepareProcessing();
+    
+    // wait for upstream data and record the time spent waiting
+    int64_t timed_wait( int64_t sequence );
+    int64_t timed_wait( int64_t sequence, int64_t time_out );
+    // record backlog and age of the oldest item for a successful retrieval
+    void record_retrieval( int64_t first_sequence, int64_t available_sequence, const IData* oldest );
+    
+    // lossy slots only: when the backlog exceeds LOSSY_SKIP_LEVEL of the
+    // ring buffer, skip ahead such that the newest n items are retrieved
+    // returns the (new) first sequence to retrieve
+    int64_t skip_overrun( int64_t first_sequence, int64_t available_sequence, int64_t n );
+    
+    void record_trace( const IData* data ) {
+        
+        if (data->traced()) { stats_.traces.Record( data->trace(), wait_end_ ); }
+    }
 	
 protected:
     int64_t time_out_;
     bool cache_enabled_;
+    bool lossy_;
+    bool fold_traces_ = false;
+    
+    const double LOSSY_SKIP_LEVEL = 0.75;
 	
 	int64_t ncached_=0;
     int64_t nretrieved_=0;
+    std::atomic<int64_t> nreleased_{0};
+    std::atomic<uint64_t> peak_backlog_{0};
 	
 	IData* cache_ = nullptr;
 	
@@ -168,6 +365,9 @@ protected:
     
 	RingSequence sequence_; // the input slot's read cursor into the buffer
 	
+	SlotStats stats_;
+	TimePoint wait_end_;
+	
 	
 };
 
@@ -191,9 +391,32 @@ public:
     
     std::string name() const { return name_; }
     
+    void set_lossy( bool value );
+    
+    // true if the data class of the port can safely be read lossily
+    // (see IData::FIXED_PAYLOAD)
+    virtual bool lossy_compatible() const = 0;
+    
+    // sleeping on all slots at once (WaitAny) needs to be enabled before the
+    // port is connected, i.e. in CreatePorts
+    void enable_wait_any() { wait_any_ = true; }
+    bool wait_any_enabled() const { return wait_any_; }
+    
+    // block until any connected slot has data available (or has been closed),
+    // until the deadline has passed or until the port is alerted
+    // returns the index of a slot with data, or -1 if the deadline has passed
+    // slots are checked round-robin, such that all slots are served fairly
+    int WaitAny( TimePoint deadline );
+    int WaitAny( int64_t time_out_micros = -1 );
+    
 protected:
+    PortNotifier notifier_;
+    bool wait_any_ = false;
+    SlotType next_slot_ = 0;
+    
     // called by StreamInConnector
     virtual void Connect( int slot, StreamOutConnector* upstream ) = 0;
+    void Disconnect( int slot, StreamOutConnector* upstream );
     virtual int ReserveSlot( int slot ) = 0;
     virtual bool CheckCompatibility( IPortOut* upstream ) = 0;
     // called by ...
@@ -206,4 +429,37 @@ private:
     PortInPolicy policy_;
 };
 
+/* PublishGroup: publishes the claimed data of several output slots together
+ * 
+ * The data of all slots is published first, followed by a single memory
+ * fence and a single pass that wakes up waiting consumers and calls the
+ * publish hooks. Consumers are therefore not woken up (and competing for the
+ * CPU) while the producer is still publishing on the remaining slots.
+ * 
+ * A consumer that waits on any of its slots (IPortIn::enable_wait_any) is
+ * connected to the group through a single port notifier, which is notified
+ * once per publication of the group, however many of its slots received
+ * data. Consumers that wait on a specific ring buffer are woken up through
+ * the wait strategy of that ring buffer.
+ * 
+ * HasCapacity tells if data can be claimed on all slots of the group without
+ * blocking, such that a producer never holds claims on some slots while it
+ * waits for room on another.
+ */
+class PublishGroup {
+public:
+    void Add( ISlotOut* slot );
+    void Add( IPortOut* port ); // all slots of the port
+    
+    std::size_t size() const { return slots_.size(); }
+    
+    bool HasCapacity() const;
+    void Publish();
+    
+protected:
+    std::vector<ISlotOut*> slots_;
+    std::vector<PortNotifier*> notifiers_; // distinct notifiers of all slots
+    std::vector<ISlotOut*> published_; // preallocated, to avoid allocation when publishing
+};
+
 #endif
@@ -0,0 +1,59 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "portpolicy.hpp"
+
+#include <stdexcept>
+
+std::string wait_strategy_to_string( WaitStrategy wait ) {
+    
+    switch (wait) {
+        case WaitStrategy::kBlockingStrategy:
+            return "blocking";
+        case WaitStrategy::kSleepingStrategy:
+            return "sleeping";
+        case WaitStrategy::kYieldingStrategy:
+            return "yielding";
+        case WaitStrategy::kHybridStrategy:
+            return "hybrid";
+        case WaitStrategy::kFutexBlockingStrategy:
+            return "futex";
+        default:
+            return "busy spin";
+    }
+}
+
+WaitStrategy wait_strategy_from_string( std::string wait ) {
+    
+    if (wait == "blocking") {
+        return WaitStrategy::kBlockingStrategy;
+    } else if (wait == "sleeping") {
+        return WaitStrategy::kSleepingStrategy;
+    } else if (wait == "yielding") {
+        return WaitStrategy::kYieldingStrategy;
+    } else if (wait == "busy spin" || wait == "busyspin") {
+        return WaitStrategy::kBusySpinStrategy;
+    } else if (wait == "hybrid") {
+        return WaitStrategy::kHybridStrategy;
+    } else if (wait == "futex") {
+        return WaitStrategy::kFutexBlockingStrategy;
+    }
+    
+    throw std::runtime_error( "Unknown wait strategy \"" + wait + "\"." );
+}
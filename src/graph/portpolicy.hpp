@@ -20,7 +20,10 @@
 #ifndef PORTPOLICY_H
 #define PORTPOLICY_H
 
+#include <string>
+
 #include "../ringbuffer.hpp"
+#include "../data/arena.hpp"
 #include "utilities/math_numeric.hpp"
 
 typedef uint16_t SlotType;
@@ -52,25 +55,59 @@ public:
     bool cache_enabled() const { return cache_enabled_; }
     int64_t time_out() const { return time_out_; }
     
+    // lossy slots do not gate the upstream producer, but skip ahead to the
+    // newest data when they fall behind (not supported for cached slots, and
+    // only for data classes with a fixed-size payload, see IData::FIXED_PAYLOAD)
+    bool lossy() const { return lossy_; }
+    void set_lossy( bool value ) { lossy_ = value; }
+    
 protected:
     bool cache_enabled_; // input slot only
     int64_t time_out_; // in microseconds, input slot only
+    bool lossy_ = false; // input slot only
 };
 
 class PortOutPolicy : public PortPolicy {
 public:
-    PortOutPolicy( SlotRange slot_number_range = SlotRange(1), int buffer_size = 200, WaitStrategy wait = WaitStrategy::kBlockingStrategy ) :
-    PortPolicy(slot_number_range), buffer_size_(buffer_size), wait_strategy_(wait)
+    PortOutPolicy( SlotRange slot_number_range = SlotRange(1), int buffer_size = 200, WaitStrategy wait = WaitStrategy::kFutexBlockingStrategy, WaitParameters wait_parameters = WaitParameters() ) :
+    PortPolicy(slot_number_range), buffer_size_(buffer_size), wait_strategy_(wait), wait_parameters_(wait_parameters)
     {}
     
     int buffer_size() const { return buffer_size_; }
     WaitStrategy wait_strategy() const { return wait_strategy_; }
+    const WaitParameters& wait_parameters() const { return wait_parameters_; }
     
     void set_buffer_size( int sz ) { buffer_size_ = sz; }
+    
+    // buffer size was requested explicitly and is left alone by automatic sizing
+    bool fixed_buffer_size() const { return fixed_buffer_size_; }
+    void set_fixed_buffer_size( bool value ) { fixed_buffer_size_ = value; }
+    void set_wait_strategy( WaitStrategy wait, WaitParameters wait_parameters = WaitParameters() ) {
+        wait_strategy_ = wait;
+        wait_parameters_ = wait_parameters;
+    }
+    
+    ItemAllocation item_allocation() const { return item_allocation_; }
+    void set_item_allocation( ItemAllocation allocation ) { item_allocation_ = allocation; }
+    
+    // slots of multi-producer ports can share their ring buffer with slots
+    // of other multi-producer ports that connect to the same input slot
+    // publications are serialised in claim order: a producer that claims an
+    // item has to publish it, since the other producers spin until it does
+    // (or until the last producer has finished)
+    bool multi_producer() const { return multi_producer_; }
+    void set_multi_producer( bool value ) { multi_producer_ = value; }
 
 protected:
     int buffer_size_; // output slot only
+    bool fixed_buffer_size_ = false; // output slot only
     WaitStrategy wait_strategy_; // ouput slot only
+    WaitParameters wait_parameters_; // output slot only
+    ItemAllocation item_allocation_ = ItemAllocation::HEAP; // output slot only
+    bool multi_producer_ = false; // output slot only
 };
 
+std::string wait_strategy_to_string( WaitStrategy wait );
+WaitStrategy wait_strategy_from_string( std::string wait );
+
 #endif // portpolicy.hpp
@@ -23,9 +23,9 @@
 #include "g3log/src/g2log.hpp"
 
 ProcessorEngine::ProcessorEngine( std::string name, std::unique_ptr<IProcessor> processor ) :
-    running_(false), thread_(), name_(name), processor_(std::move(processor)), 
+    running_(false), thread_(), items_start_(0), name_(name), processor_(std::move(processor)), 
     has_test_flag_(false), test_flag_(false),
-    thread_priority_(PRIORITY_NONE), thread_core_(CORE_NOT_PINNED) {
+    thread_priority_(PRIORITY_NONE), thread_core_(CORE_NOT_PINNED), configured_thread_core_(CORE_NOT_PINNED) {
 
     processor_->set_name(name_);
 }
@@ -36,6 +36,7 @@ ProcessorEngine::~ProcessorEngine() {
     
     // if running, stop
     Stop();
+    thread_.Shutdown();
     
     // delete processor
     processor_.reset();
@@ -49,6 +50,39 @@ void ProcessorEngine::ThreadEntry( RunContext& runcontext ) {
     
     LOG(DEBUG) << name_ << ": processor test flag set to " << context.test();
     
+    if (runcontext.realtime_profile!=nullptr) {
+        runcontext.realtime_profile->PrepareThread( name_, thread_priority_>=PRIORITY_MIN );
+    }
+    
+    EnterProcessing( context );
+
+    // wait for the go signal
+    {
+        std::unique_lock<std::mutex> lock(runcontext.mutex);
+        while (!runcontext.go_signal) { runcontext.go_condition.wait(lock); }
+    }
+    
+    items_start_ = processor_->item_count();
+    accounting_.Begin();
+    
+    try {
+        processor_->Process(context);
+    } catch (std::exception& e) {
+        context.TerminateWithError( "Process", e.what() );
+    }
+    
+    accounting_.End();
+    
+    ExitProcessing( context );
+    
+    LOG(INFO) << name_ << (fused_engines_.empty() ? ". " : " (including fused processors). ")
+        << accounting_.current().string( items_processed() );
+    
+    LOG(DEBUG) << "Exiting thread for processor " << name_;
+}
+
+void ProcessorEngine::EnterProcessing( ProcessingContext& context ) {
+    
     PrepareProcessing();
     
     try {
@@ -64,18 +98,17 @@ void ProcessorEngine::ThreadEntry( RunContext& runcontext ) {
     }
     
     running_.store(true);
-
-    // wait for the go signal
-    {
-        std::unique_lock<std::mutex> lock(runcontext.mutex);
-        while (!runcontext.go_signal) { runcontext.go_condition.wait(lock); }
-    }
     
-    try {
-        processor_->Process(context);
-    } catch (std::exception& e) {
-        context.TerminateWithError( "Process", e.what() );
+    // fused processors run in this thread
+    for (auto & engine : fused_engines_) {
+        engine->fused_context_.reset( new ProcessingContext( context.run(), engine->name(),
+            engine->has_test_flag() ? engine->test_flag() : context.run().test() ) );
+        engine->fused_done_ = false;
+        engine->EnterProcessing( *engine->fused_context_ );
     }
+}
+
+void ProcessorEngine::ExitProcessing( ProcessingContext& context ) {
     
     try {
         processor_->Postprocess(context);
@@ -92,7 +125,86 @@ void ProcessorEngine::ThreadEntry( RunContext& runcontext ) {
     
     running_.store(false);
     
-    LOG(DEBUG) << "Exiting thread for processor " << name_;
+    // no more publications from this thread: restore a close that raced
+    // with the last publication (after a fence, such that a close that was
+    // overwritten is visible)
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    processor_->RecloseOutputs();
+    
+    for (auto & engine : fused_engines_) {
+        engine->FinishInline();
+        engine->ExitProcessing( *engine->fused_context_ );
+        engine->fused_context_.reset();
+    }
+}
+
+void ProcessorEngine::FuseInto( ProcessorEngine* upstream, ISlotIn* input ) {
+    
+    if (!processor_->steppable()) {
+        throw InvalidProcessorError( "Processor does not support step-wise processing and cannot be fused.", name_ );
+    }
+    
+    if (!thread_group_.empty()) {
+        throw InvalidProcessorError( "Processor in a thread group cannot be fused.", name_ );
+    }
+    
+    fused_upstream_ = upstream;
+    fused_input_ = input;
+    upstream->fused_engines_.push_back( this );
+}
+
+void ProcessorEngine::ProcessInline() {
+    
+    if (fused_context_==nullptr || fused_done_) { return; }
+    
+    unsigned int full_rounds = 0;
+    
+    // process all available data, such that the intermediate ring buffer
+    // never fills up and the upstream processor cannot block on it
+    while (!fused_done_ && fused_input_->DataAvailable() && !fused_context_->terminated()) {
+        
+        if (!processor_->ReadyForStep()) {
+            // downstream of the fused processor is full: back off like an
+            // idle thread group, such that a stalled consumer does not
+            // keep the core busy
+            if (full_rounds < FULL_YIELD_ROUNDS) {
+                ++full_rounds;
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for( std::chrono::microseconds( FULL_SLEEP_MICROS ) );
+            }
+            continue;
+        }
+        full_rounds = 0;
+        
+        try {
+            fused_done_ = processor_->ProcessStep( *fused_context_ )==StepResult::DONE;
+        } catch (std::exception& e) {
+            fused_context_->TerminateWithError( "Process", e.what() );
+            fused_done_ = true;
+        }
+    }
+}
+
+void ProcessorEngine::FinishInline() {
+    
+    if (fused_context_==nullptr) { return; }
+    
+    // process the data that is left (when stopping, the input slot has been
+    // alerted and there is nothing left to process)
+    ProcessInline();
+    
+    // a last step sees the end of the stream, such that the processor can
+    // publish partial results like its threaded Process does
+    fused_input_->Close();
+    if (!fused_done_) {
+        try {
+            fused_done_ = processor_->ProcessStep( *fused_context_ )==StepResult::DONE;
+        } catch (std::exception& e) {
+            fused_context_->TerminateWithError( "Process", e.what() );
+            fused_done_ = true;
+        }
+    }
 }
 
 void ProcessorEngine::Configure( const YAML::Node& node, const GlobalContext& context ) {
@@ -108,21 +220,72 @@ void ProcessorEngine::Configure( const YAML::Node& node, const GlobalContext& co
     if (node["advanced"]) {
         thread_priority_ = node["advanced"]["threadpriority"].as<ThreadPriority>( processor_->default_thread_priority() );
         thread_core_ = node["advanced"]["threadcore"].as<ThreadCore>( CORE_NOT_PINNED );
+        thread_group_ = node["advanced"]["threadgroup"].as<std::string>( "" );
+        fuse_ = node["advanced"]["fuse"].as<bool>( false );
+        isolate_ = node["advanced"]["isolate"].as<bool>( false );
 
         if (node["advanced"]["buffer_sizes"]) {
             requested_buffer_sizes_ = node["advanced"]["buffer_sizes"].as<std::map<std::string,int>>( );
         }
+        
+        // wait_strategies:
+        //     port: strategy
+        //     port: {strategy: hybrid, spin_tries: 5000, yield_tries: 50}
+        if (node["advanced"]["wait_strategies"]) {
+            requested_wait_strategies_.clear();
+            for (auto & it : node["advanced"]["wait_strategies"]) {
+                WaitStrategy strategy;
+                WaitParameters parameters;
+                if (it.second.IsMap()) {
+                    strategy = wait_strategy_from_string( it.second["strategy"].as<std::string>() );
+                    parameters = WaitParameters(
+                        it.second["spin_tries"].as<int>( parameters.spin_tries ),
+                        it.second["yield_tries"].as<int>( parameters.yield_tries ) );
+                } else {
+                    strategy = wait_strategy_from_string( it.second.as<std::string>() );
+                }
+                requested_wait_strategies_[it.first.as<std::string>()] = std::make_pair( strategy, parameters );
+            }
+        }
+        
+        // multi_producer: [port, ...]
+        if (node["advanced"]["multi_producer"]) {
+            auto ports = node["advanced"]["multi_producer"].as<std::vector<std::string>>();
+            requested_multi_producer_ports_ = std::set<std::string>( ports.begin(), ports.end() );
+        }
+        
+        // lossy: [port, ...]
+        if (node["advanced"]["lossy"]) {
+            auto ports = node["advanced"]["lossy"].as<std::vector<std::string>>();
+            requested_lossy_ports_ = std::set<std::string>( ports.begin(), ports.end() );
+        }
+        
+        // ring_allocation:
+        //     port: heap | arena | transparent_hugepages | hugepages
+        if (node["advanced"]["ring_allocation"]) {
+            requested_ring_allocations_.clear();
+            for (auto & it : node["advanced"]["ring_allocation"]) {
+                requested_ring_allocations_[it.first.as<std::string>()] =
+                    item_allocation_from_string( it.second.as<std::string>() );
+            }
+        }
     } else {
         thread_priority_ = processor_->default_thread_priority();
         thread_core_ = CORE_NOT_PINNED;
+        thread_group_ = "";
+        fuse_ = false;
+        isolate_ = false;
     }
     
+    configured_thread_core_ = thread_core_;
+    
     processor_->Configure( node["options"], context );
 }
 
 void ProcessorEngine::CreatePorts() {
     
-    processor_->CreatePortsInternal( requested_buffer_sizes_ );
+    processor_->CreatePortsInternal( requested_buffer_sizes_, requested_wait_strategies_,
+        requested_ring_allocations_, requested_multi_producer_ports_, requested_lossy_ports_ );
 }
 
 void ProcessorEngine::NegotiateConnections() {
@@ -130,6 +293,11 @@ void ProcessorEngine::NegotiateConnections() {
     processor_->NegotiateConnections();
 }
 
+void ProcessorEngine::AutoSizeRingBuffers( const RingSizing& sizing ) {
+    
+    processor_->AutoSizeRingBuffers( sizing );
+}
+
 void ProcessorEngine::CreateRingBuffers() {
     
     processor_->CreateRingBuffers();
@@ -160,30 +328,20 @@ void ProcessorEngine::Start(RunContext& runcontext) {
     if (!running_) {
         Stop();
         
-        thread_ = std::thread( &ProcessorEngine::ThreadEntry, this, std::ref(runcontext) );
-        
-        if (!set_realtime_priority( thread_.native_handle(), thread_priority_)) {
-            LOG(WARNING) << "Unable to set thread priority for " << name_;
-        } else if (thread_priority_>=PRIORITY_MIN) {
-            LOG(INFO) << "Successfully set thread priority for " << name_ << " to " << thread_priority_ << "%.";
+        // the thread is kept between runs of the graph
+        RunContext* context = &runcontext;
+        if (!thread_.Run( [this, context]() { ThreadEntry( *context ); } )) {
+            LOG(DEBUG) << "Reusing thread for processor " << name_;
         }
         
-        if (!set_thread_core( thread_.native_handle(), thread_core_)) {
-            LOG(WARNING) << "Unable to pin thread for " << name_ << " to core "
-                << thread_core_;
-        } else if (thread_core_>=0) {
-            LOG(INFO) << "Successfully pinned thread for " << name_ << " to core "
-                << thread_core_ << ".";
-        }
-        
-        
+        thread_.ApplyScheduling( thread_priority_, thread_core_, name_ );
     }
 }
 
 void ProcessorEngine::Stop() {
     
-    if( thread_.joinable()) thread_.join();
-    LOG(DEBUG) << name() << ": thread joined";
+    thread_.Wait();
+    LOG(DEBUG) << name() << ": run finished";
 }
 
 void ProcessorEngine::Alert() {
@@ -191,6 +349,24 @@ void ProcessorEngine::Alert() {
     processor_->Alert();
 }
 
+uint64_t ProcessorEngine::items_processed() {
+    
+    // the counts are reset when a new run is prepared, before items_start_ is taken
+    uint64_t count = processor_->item_count();
+    uint64_t start = items_start_.load();
+    return count>start ? count-start : 0;
+}
+
+YAML::Node ProcessorEngine::ExportUsage() {
+    
+    YAML::Node node = accounting_.current().ExportYAML( items_processed() );
+    node["running"] = accounting_.active();
+    for (auto & engine : fused_engines_) {
+        node["fused"].push_back( engine->name() );
+    }
+    return node;
+}
+
 YAML::Node ProcessorEngine::ExportYAML( ) {
     
     return processor_->ExportYAML();
@@ -25,9 +25,13 @@
 #include <thread>
 #include <atomic>
 #include <map>
+#include <set>
 #include <utility>
+#include <vector>
 
 #include "threadutilities.hpp"
+#include "portpolicy.hpp"
+#include "ringsizing.hpp"
 
 #include "runinfo.hpp"
 //#include "iprocessor.hpp"
@@ -35,6 +39,7 @@
 
 // forward declaration
 class IProcessor;
+class ISlotIn;
 
 class ProcessorEngine final {
 public:
@@ -45,10 +50,26 @@ public:
     
     void ThreadEntry(RunContext& runcontext);
     
+    // processing steps that precede and follow the Process call, also used
+    // by a ThreadGroup that runs the processor on a shared thread
+    void EnterProcessing( ProcessingContext& context );
+    void ExitProcessing( ProcessingContext& context );
+    
+    // fusion: run this processor inline in the thread of the upstream
+    // processor, right after data is published on the input slot
+    bool fuse_requested() const { return fuse_; }
+    bool fused() const { return fused_upstream_!=nullptr; }
+    ProcessorEngine* fused_upstream() const { return fused_upstream_; }
+    void FuseInto( ProcessorEngine* upstream, ISlotIn* input );
+    void ProcessInline();
+    // called by the upstream processor after its last publication
+    void FinishInline();
+    
     void Configure(const YAML::Node& node, const GlobalContext& context);
     void CreatePorts();
     
     void NegotiateConnections();
+    void AutoSizeRingBuffers( const RingSizing& sizing );
     void CreateRingBuffers();
     
     void PrepareProcessing();
@@ -68,13 +89,31 @@ public:
     
     bool running() const { return running_.load(); };
     
+    ThreadPriority thread_priority() const { return thread_priority_; }
+    ThreadCore thread_core() const { return thread_core_; }
+    void assign_thread_core( ThreadCore core ) { thread_core_ = core; }
+    // undo an automatic core assignment (e.g. when the engine is kept in a rebuilt graph)
+    void reset_thread_core() { thread_core_ = configured_thread_core_; }
+    bool isolate_requested() const { return isolate_; }
+    const std::string& thread_group() const { return thread_group_; }
+    
+    // CPU time and context switches of the processing thread in the current
+    // or last run (for processors that run on their own thread)
+    YAML::Node ExportUsage();
+    
+    bool has_test_flag() const { return has_test_flag_.load(); }
+    bool test_flag() const { return test_flag_.load(); }
+    
 protected:
     std::atomic<bool> running_;
     
     bool negotiated_ = false;
     bool prepared_ = false;
         
-    std::thread thread_;
+    PersistentThread thread_;
+    ThreadAccounting accounting_;
+    std::atomic<uint64_t> items_start_;
+    uint64_t items_processed();
     std::string name_;
     
     std::unique_ptr<IProcessor> processor_;
@@ -84,9 +123,29 @@ protected:
     
     ThreadPriority thread_priority_;
     ThreadCore thread_core_;
+    ThreadCore configured_thread_core_;
+    std::string thread_group_;
+    bool isolate_ = false;
+    
+    bool fuse_ = false;
+    ProcessorEngine* fused_upstream_ = nullptr;
+    ISlotIn* fused_input_ = nullptr;
+    std::vector<ProcessorEngine*> fused_engines_;
+    std::unique_ptr<ProcessingContext> fused_context_;
+    bool fused_done_ = false;
     
     std::map<std::string, int> requested_buffer_sizes_;
+    std::map<std::string, std::pair<WaitStrategy, WaitParameters>> requested_wait_strategies_;
+    std::map<std::string, ItemAllocation> requested_ring_allocations_;
+    std::set<std::string> requested_multi_producer_ports_;
+    std::set<std::string> requested_lossy_ports_;
     
+public:
+    // fused processing with a full downstream ring buffer: number of rounds
+    // in which the thread yields, before sleeping
+    const unsigned int FULL_YIELD_ROUNDS = 1000;
+    // sleep time while the downstream ring buffer is full, in microseconds
+    const unsigned int FULL_SLEEP_MICROS = 50;
 };
 
 typedef std::map<std::string, std::pair< std::string, std::unique_ptr<ProcessorEngine>>> ProcessorEngineMap;
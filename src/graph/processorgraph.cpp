@@ -17,6 +17,7 @@
 // along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
 // ---------------------------------------------------------------------
 
+#include <algorithm>
 #include <iostream>
 #include <exception>
 #include <regex>
@@ -25,6 +26,7 @@
 #include "iprocessor.hpp"
 #include "g3log/src/g2log.hpp"
 #include "utilities/general.hpp"
+#include "cpuplacement.hpp"
 
 using namespace graph;
 
@@ -108,7 +110,7 @@ std::vector<std::string> expandProcessorName( std::string s ) {
     
 }
 
-void ConstructProcessorEngines( const YAML::Node& node, ProcessorEngineMap& engines, const GlobalContext& context) {
+void ConstructProcessorEngines( const YAML::Node& node, ProcessorEngineMap& engines, const GlobalContext& context, const std::set<std::string>& retained ) {
     
     std::vector<std::string> processor_name_list;
     std::string processor_name;
@@ -132,6 +134,12 @@ void ConstructProcessorEngines( const YAML::Node& node, ProcessorEngineMap& engi
                 
                 processor_name = name_it;
                 
+                // processor kept from the previous graph (already configured)
+                if ( retained.count( processor_name )>0 ) {
+                    LOG(DEBUG) << "Kept processor " << processor_name << " (" << processor_class << ") from previous graph.";
+                    continue;
+                }
+                
                 // does processor already exist?
                 auto it2 = engines.find( processor_name );
                 
@@ -174,11 +182,511 @@ void ParseConnectionRules( const YAML::Node& node, StreamConnections& connection
     }
 }
 
+// canonical text of a YAML node for comparing definitions: map keys are
+// sorted, since yaml-cpp does not keep the order of the keys in a map
+std::string definitionString( const YAML::Node& node ) {
+    
+    if (!node) { return std::string(); }
+    
+    std::string s;
+    
+    switch (node.Type()) {
+    case YAML::NodeType::Scalar:
+        return YAML::Dump( YAML::Node( node.Scalar() ) );
+    case YAML::NodeType::Sequence:
+        for (auto it=node.begin(); it!=node.end(); ++it) {
+            s += (s.empty() ? "" : ", ") + definitionString( *it );
+        }
+        return "[" + s + "]";
+    case YAML::NodeType::Map: {
+        std::map<std::string, std::string> entries;
+        for (auto it=node.begin(); it!=node.end(); ++it) {
+            entries[definitionString( it->first )] = definitionString( it->second );
+        }
+        for (auto & it : entries) {
+            s += (s.empty() ? "" : ", ") + it.first + ": " + it.second;
+        }
+        return "{" + s + "}";
+    }
+    default:
+        return "~";
+    }
+}
+
+// processor name -> (class, definition) for all processors in the YAML document
+std::map<std::string, std::pair<std::string, std::string>> ProcessorDefinitions( const YAML::Node& node ) {
+    
+    std::map<std::string, std::pair<std::string, std::string>> definitions;
+    
+    if (!node || !node.IsMap()) { return definitions; }
+    
+    for(YAML::const_iterator it=node.begin();it!=node.end();++it) {
+        std::string processor_class = it->second["class"] ? it->second["class"].as<std::string>() : "";
+        std::string definition = definitionString( it->second );
+        for (auto & name : expandProcessorName( it->first.as<std::string>() )) {
+            definitions[name] = std::make_pair( processor_class, definition );
+        }
+    }
+    
+    return definitions;
+}
+
+// processor name -> connection rules that the processor is part of
+std::map<std::string, std::set<std::string>> ConnectionRulesByProcessor( const StreamConnections& connections ) {
+    
+    std::map<std::string, std::set<std::string>> rules;
+    
+    for (auto & it : connections) {
+        rules[it->out_address().processor()].insert( it->rule() );
+        rules[it->in_address().processor()].insert( it->rule() );
+    }
+    
+    return rules;
+}
+
+// processor name -> shared state links that the processor is part of
+std::map<std::string, std::set<std::string>> StateLinks( const YAML::Node& node ) {
+    
+    std::map<std::string, std::set<std::string>> links;
+    
+    if (!node || !node.IsSequence()) { return links; }
+    
+    for(YAML::const_iterator link=node.begin();link!=node.end();++link) {
+        if (!link->IsSequence()) { continue; } // reported by LinkSharedStates
+        std::string definition = definitionString( *link );
+        for(YAML::const_iterator state=link->begin();state!=link->end();++state) {
+            std::vector<std::string> address = split( state->as<std::string>(), '.' );
+            if (address.size()!=2) { continue; }
+            for (auto & name : expandProcessorName( address[0] )) {
+                links[name].insert( definition );
+            }
+        }
+    }
+    
+    return links;
+}
+
 std::string ProcessorGraph::state_string() const {
     
     return graph_state_string( state_ );
 }
 
+void ProcessorGraph::ConstructThreadGroups() {
+    
+    thread_groups_.clear();
+    
+    for (auto &it : this->engines_) {
+        
+        std::string group = it.second.second->thread_group();
+        if (group.empty()) { continue; }
+        
+        if (thread_groups_.count( group )==0) {
+            thread_groups_[group].reset( new ThreadGroup( group ) );
+        }
+        
+        thread_groups_[group]->AddProcessor( it.second.second.get() );
+        LOG(DEBUG) << "Added processor " << it.first << " to thread group " << group;
+    }
+    
+    if (thread_groups_.size()>0) {
+        LOG(INFO) << "Constructed " << thread_groups_.size() << " thread group(s).";
+    }
+}
+
+std::vector<ProcessorEngine*> ProcessorGraph::TopologicalOrder() {
+    
+    // distinct upstream and downstream processors
+    std::map<std::string, std::set<std::string>> upstream;
+    std::map<std::string, std::set<std::string>> downstream;
+    for (auto &it : connections_) {
+        std::string source = it->out_connector()->address().processor();
+        std::string destination = it->in_connector()->address().processor();
+        if (source==destination) { continue; }
+        upstream[destination].insert( source );
+        downstream[source].insert( destination );
+    }
+    
+    std::set<std::string> ready;
+    std::set<std::string> remaining;
+    for (auto &it : this->engines_) {
+        if (upstream[it.first].empty()) { ready.insert( it.first ); }
+        else { remaining.insert( it.first ); }
+    }
+    
+    std::vector<ProcessorEngine*> order;
+    
+    while (!ready.empty() || !remaining.empty()) {
+        
+        // break cycles by taking the first remaining processor
+        if (ready.empty()) {
+            ready.insert( *remaining.begin() );
+            remaining.erase( remaining.begin() );
+        }
+        
+        std::string name = *ready.begin();
+        ready.erase( ready.begin() );
+        order.push_back( engines_[name].second.get() );
+        
+        for (auto & next : downstream[name]) {
+            upstream[next].erase( name );
+            if (upstream[next].empty() && remaining.erase( next )>0) {
+                ready.insert( next );
+            }
+        }
+    }
+    
+    return order;
+}
+
+void ProcessorGraph::ConstructOfflineGroup() {
+    
+    offline_group_.reset( new ThreadGroup( "offline" ) );
+    std::vector<std::string> threaded;
+    
+    for (auto & engine : TopologicalOrder()) {
+        if (engine->fused()) { continue; }
+        if (engine->processor()->steppable()) {
+            offline_group_->AddProcessor( engine );
+        } else {
+            threaded.push_back( engine->name() );
+        }
+    }
+    
+    // the group can only tell that all data has been processed if it runs all processors
+    offline_group_->set_offline( threaded.empty() );
+    
+    if (!threaded.empty()) {
+        LOG(WARNING) << "Processor(s) " << join( threaded.begin(), threaded.end(), std::string(", ") )
+            << " do not support step-wise processing and run in their own thread. The graph needs to be stopped explicitly.";
+    }
+    
+    if (offline_group_->processors().empty()) {
+        offline_group_.reset();
+    } else {
+        LOG(INFO) << "Running " << offline_group_->processors().size() << " processor(s) offline in a single thread.";
+    }
+}
+
+void ProcessorGraph::ConstructFusedChains() {
+    
+    for (auto &it : this->engines_) {
+        
+        ProcessorEngine* engine = it.second.second.get();
+        if (!engine->fuse_requested() || engine->fused()) { continue; }
+        
+        // a fused processor has a single incoming connection
+        StreamConnection* connection = nullptr;
+        for (auto & conn : connections_) {
+            if (conn->in_connector()->address().processor()==it.first) {
+                if (connection!=nullptr) {
+                    throw InvalidGraphError( "Processor " + it.first + " cannot be fused: it has more than one incoming connection." );
+                }
+                connection = conn.get();
+            }
+        }
+        
+        if (connection==nullptr) {
+            throw InvalidGraphError( "Processor " + it.first + " cannot be fused: it has no incoming connection." );
+        }
+        
+        ProcessorEngine* upstream = engines_[connection->out_connector()->address().processor()].second.get();
+        
+        engine->FuseInto( upstream, connection->in_connector()->slot() );
+        connection->out_connector()->slot()->AddPublishHook( [engine]() { engine->ProcessInline(); } );
+        
+        LOG(INFO) << "Fused processor " << it.first << " into the thread of processor " << upstream->name() << ".";
+    }
+    
+    // every chain of fused processors should start at a processor with its own thread
+    for (auto &it : this->engines_) {
+        ProcessorEngine* engine = it.second.second.get();
+        unsigned int n = 0;
+        while (engine->fused()) {
+            engine = engine->fused_upstream();
+            if (++n > engines_.size()) {
+                throw InvalidGraphError( "Processor " + it.first + " is part of a cycle of fused processors." );
+            }
+        }
+    }
+}
+
+void ProcessorGraph::PlanCpuPlacement() {
+    
+    const std::string group_prefix = "threadgroup:";
+    
+    std::vector<PlacementTask> tasks;
+    std::vector<PlacementEdge> edges;
+    std::map<std::string, std::string> processor_task;
+    
+    // every thread is a placement task: processors with their own thread
+    // and thread groups; fused processors run in the thread of their chain
+    for (auto &it : this->engines_) {
+        ProcessorEngine* engine = it.second.second.get();
+        ProcessorEngine* root = engine;
+        while (root->fused()) { root = root->fused_upstream(); }
+        
+        processor_task[it.first] = root->thread_group().empty() ? root->name() : group_prefix + root->thread_group();
+        
+        if (engine==root && root->thread_group().empty()) {
+            tasks.push_back( PlacementTask{ it.first,
+                engine->processor()->issource() || engine->isolate_requested(),
+                engine->thread_core() } );
+        }
+    }
+    
+    for (auto &it : this->thread_groups_) {
+        bool critical = false;
+        for (auto & engine : it.second->processors()) {
+            critical = critical || engine->processor()->issource() || engine->isolate_requested();
+        }
+        tasks.push_back( PlacementTask{ group_prefix + it.first, critical, it.second->thread_core() } );
+    }
+    
+    for (auto &it : connections_) {
+        std::string from = processor_task[it->out_connector()->address().processor()];
+        std::string to = processor_task[it->in_connector()->address().processor()];
+        if (from==to) { continue; }
+        double rate = it->out_connector()->slot()->streaminfo().stream_rate();
+        edges.push_back( PlacementEdge{ from, to, rate<=IRREGULARSTREAM ? 0.0 : rate } );
+    }
+    
+    auto plan = ::PlanCpuPlacement( CpuTopology::FromSysfs(), tasks, edges );
+    
+    for (auto & entry : plan) {
+        if (entry.task.compare( 0, group_prefix.size(), group_prefix )==0) {
+            thread_groups_[entry.task.substr( group_prefix.size() )]->assign_thread_core( entry.core );
+        } else {
+            engines_[entry.task].second->assign_thread_core( entry.core );
+        }
+        LOG(INFO) << "CPU placement: " << entry.task << " on core " << entry.core << " (" << entry.reason << ")";
+    }
+    
+    cpu_placement_ = ExportPlacementYAML( plan );
+}
+
+void ProcessorGraph::BindRingBuffersToNuma() {
+    
+    for (auto &it : connections_) {
+        // ring buffers of retained processors exist already
+        if (retained_.count( it->out_connector()->address().processor() )>0) { continue; }
+        
+        ISlotOut* slot = it->out_connector()->slot();
+        slot->set_numa_node( -1 );
+        
+        // the consumer runs in the thread of its fused chain or thread group
+        ProcessorEngine* consumer = engines_[it->in_connector()->address().processor()].second.get();
+        while (consumer->fused()) { consumer = consumer->fused_upstream(); }
+        ThreadCore core = consumer->thread_group().empty() ?
+            consumer->thread_core() : thread_groups_[consumer->thread_group()]->thread_core();
+        
+        int numa_node = numa_node_of_cpu( core );
+        if (numa_node>=0) {
+            slot->set_numa_node( numa_node );
+            LOG(DEBUG) << "Ring buffer of " << it->out_connector()->address().string() << " bound to NUMA node " << numa_node;
+        }
+    }
+}
+
+void ProcessorGraph::ConfigureTracing( const YAML::Node& node ) {
+    
+    // tracing: N
+    // every Nth item published by a source processor carries a latency trace,
+    // which is folded into the slot statistics of the sink processors
+    uint64_t interval = 0;
+    if (node) {
+        int value = node.as<int>();
+        if (value<0) {
+            throw InvalidGraphError( "Tracing interval should be a positive number." );
+        }
+        interval = value;
+    }
+    
+    trace_hops_.clear();
+    std::map<ISlotOut*, uint32_t> hops;
+    
+    for (auto &it : connections_) {
+        ISlotOut* out = it->out_connector()->slot();
+        if (hops.count( out )==0) {
+            hops[out] = trace_hops_.size();
+            trace_hops_.push_back( it->out_connector()->string() );
+            out->set_tracing( hops[out], it->out_connector()->processor()->issource() ? interval : 0 );
+        }
+        it->in_connector()->slot()->set_fold_traces( interval>0 && it->in_connector()->processor()->issink() );
+    }
+    
+    if (interval>0) {
+        LOG(INFO) << "Tracing latency of every " << interval << "th item of source processors.";
+    }
+}
+
+void ProcessorGraph::CreateDeadlineStates() {
+    
+    if (!deadlines_.enabled() || !deadlines_.state()) { return; }
+    
+    // retained processors may have the state already
+    for (auto &it : this->engines_) {
+        IProcessor* processor = it.second.second->processor();
+        if (!processor->has_shared_state( Deadlines::STATE_NAME )) {
+            processor->create_writable_shared_state<bool>( Deadlines::STATE_NAME, false, Permission::READ, Permission::READ );
+        }
+    }
+}
+
+void ProcessorGraph::ConfigureDeadlines() {
+    
+    for (auto &it : connections_) {
+        it->out_connector()->slot()->set_deadline_monitor( nullptr );
+    }
+    deadline_monitors_.clear();
+    deadline_flags_.clear();
+    
+    if (!deadlines_.enabled()) { return; }
+    
+    // input slots per processor, to measure lag relative to the input
+    std::map<IProcessor*, std::vector<ISlotIn*>> inputs;
+    for (auto &it : connections_) {
+        inputs[it->in_connector()->processor()].push_back( it->in_connector()->slot() );
+    }
+    
+    std::set<ISlotOut*> monitored;
+    
+    for (auto &it : connections_) {
+        ISlotOut* slot = it->out_connector()->slot();
+        if (monitored.count( slot )>0) { continue; }
+        monitored.insert( slot );
+        
+        // the rate of a shared ring buffer is not attributable to a single producer
+        double rate = slot->streaminfo().stream_rate();
+        if (rate<=IRREGULARSTREAM || slot->shared()) { continue; }
+        
+        IProcessor* processor = it->out_connector()->processor();
+        auto & flag = deadline_flags_[processor->name()];
+        if (!flag) {
+            WritableState<bool>* state = nullptr;
+            if (deadlines_.state() && processor->has_shared_state( Deadlines::STATE_NAME )) {
+                state = dynamic_cast<WritableState<bool>*>( processor->shared_state( Deadlines::STATE_NAME ) );
+            }
+            flag.reset( new DeadlineFlag( state ) );
+        }
+        
+        std::function<bool()> input_pending;
+        if (inputs.count( processor )>0) {
+            std::vector<ISlotIn*> slots = inputs[processor];
+            input_pending = [slots]() {
+                for (auto & s : slots) { if (s->DataAvailable()) { return true; } }
+                return false;
+            };
+        }
+        
+        deadline_monitors_.emplace_back( new DeadlineMonitor( it->out_connector()->string(), rate, deadlines_, flag.get(), input_pending ) );
+        slot->set_deadline_monitor( deadline_monitors_.back().get() );
+    }
+    
+    LOG(INFO) << "Monitoring deadlines of " << deadline_monitors_.size() << " output slot(s).";
+}
+
+void ProcessorGraph::ReportDeadlines() {
+    
+    for (auto &monitor : deadline_monitors_) {
+        if (monitor->noverruns()>0) {
+            LOG(WARNING) << monitor->name() << " overran its publication budget " << monitor->noverruns()
+                << " times (maximum lag " << monitor->max_lag_ns()/1e6 << " ms).";
+        }
+        if (monitor->nprocessing_overruns()>0) {
+            LOG(WARNING) << monitor->name() << " took longer than its publication budget to process "
+                << monitor->nprocessing_overruns() << " times.";
+        }
+    }
+}
+
+YAML::Node ProcessorGraph::ExportDeadlines() {
+    
+    YAML::Node node( YAML::NodeType::Map );
+    
+    for (auto &monitor : deadline_monitors_) {
+        node[monitor->name()] = monitor->ExportYAML();
+    }
+    
+    return node;
+}
+
+void ProcessorGraph::AutoSizeRingBuffers() {
+    
+    for (auto &it : this->engines_) {
+        if (retained_.count( it.first )>0) { continue; }
+        it.second.second->AutoSizeRingBuffers( ring_sizing_ );
+    }
+}
+
+void ProcessorGraph::RecommendRingSizes() {
+    
+    // the peak backlog of a ring buffer is the largest backlog seen by any of
+    // its consumers during the run that just finished
+    std::map<std::string, uint64_t> peak;
+    std::map<std::string, ISlotOut*> slots;
+    for (auto &it : connections_) {
+        std::string address = it->out_connector()->string();
+        uint64_t backlog = it->in_connector()->slot()->peak_backlog();
+        peak[address] = std::max( peak[address], backlog );
+        slots[address] = it->out_connector()->slot();
+    }
+    
+    for (auto &it : peak) {
+        int size = slots[it.first]->buffer_size();
+        int recommended = ring_sizing_.recommend( it.second );
+        
+        YAML::Node entry = ring_sizing_report_[it.first];
+        entry["peak_backlog"] = it.second;
+        entry["recommended_size"] = recommended;
+        
+        if (recommended > size) {
+            LOG(WARNING) << "Ring buffer of " << it.first << " (size " << size << ") reached a backlog of "
+                << it.second << " items. Recommended size: " << recommended << ".";
+        } else if (recommended < size) {
+            LOG(INFO) << "Ring buffer of " << it.first << " (size " << size << ") reached a backlog of "
+                << it.second << " items. Recommended size: " << recommended << ".";
+        }
+    }
+}
+
+YAML::Node ProcessorGraph::ExportSlotStats( bool reset ) {
+    
+    YAML::Node node( YAML::NodeType::Map );
+    
+    for (auto &it : connections_) {
+        ISlotIn* slot = it->in_connector()->slot();
+        YAML::Node stats = slot->stats().ExportYAML( trace_hops_ );
+        stats["upstream"] = it->out_connector()->string();
+        node[it->in_connector()->string()] = stats;
+        if (reset) { slot->ResetStats(); }
+    }
+    
+    return node;
+}
+
+YAML::Node ProcessorGraph::ExportThreadUsage() {
+    
+    YAML::Node node( YAML::NodeType::Map );
+    
+    // processors with their own thread (including fused processors)
+    for (auto &it : this->engines_) {
+        ProcessorEngine* engine = it.second.second.get();
+        if (engine->fused()) { continue; }
+        if (offline_group_ ? offline_group_->contains( engine ) : !engine->thread_group().empty()) { continue; }
+        node[it.first] = engine->ExportUsage();
+    }
+    
+    if (offline_group_) {
+        node["threadgroup:offline"] = offline_group_->ExportUsage();
+    } else {
+        for (auto &it : this->thread_groups_) {
+            node["threadgroup:" + it.first] = it.second->ExportUsage();
+        }
+    }
+    
+    return node;
+}
+
 void ProcessorGraph::LinkSharedStates( const YAML::Node& node ) {
     
     // node is a sequence
@@ -196,6 +704,7 @@ void ProcessorGraph::LinkSharedStates( const YAML::Node& node ) {
         }
 
         std::vector<std::pair<std::string, IState*>> states;
+        std::set<std::string> processors;
 
         // loop through items in sequence
         for(YAML::const_iterator linked_state=link->begin();linked_state!=link->end();
@@ -242,6 +751,7 @@ void ProcessorGraph::LinkSharedStates( const YAML::Node& node ) {
                 }
 
                 ProcessorEngine* engine = engines_[itv.first].second.get();
+                processors.insert( itv.first );
 
                 // look up state
                 states.push_back( std::make_pair( linked_state->as<std::string>(),
@@ -252,6 +762,12 @@ void ProcessorGraph::LinkSharedStates( const YAML::Node& node ) {
 
         if (states.size()<2) {continue;} // nothing to link
         
+        // states of processors kept from the previous graph are linked already
+        if (std::all_of( processors.begin(), processors.end(),
+            [this]( const std::string& name ) { return retained_.count( name )>0; } )) {
+            continue;
+        }
+        
         // check if all states are compatible with each other
         for (unsigned int m=0; m<states.size(); ++m) {
             for (unsigned int n=m+1; n<states.size(); ++n) {
@@ -283,9 +799,215 @@ void ProcessorGraph::LinkSharedStates( const YAML::Node& node ) {
     }
 }
 
+std::set<std::string> ProcessorGraph::RetainedProcessors( const YAML::Node& node, const StreamConnections& connections ) {
+    
+    std::set<std::string> retained;
+    const YAML::Node& previous = yaml_;
+    
+    // ring buffers of retained processors are not resized
+    if (definitionString( previous["ring_sizing"] )!=definitionString( node["ring_sizing"] )) {
+        return retained;
+    }
+    
+    auto old_definitions = ProcessorDefinitions( previous["processors"] );
+    auto new_definitions = ProcessorDefinitions( node["processors"] );
+    auto old_rules = ConnectionRulesByProcessor( connections_ );
+    auto new_rules = ConnectionRulesByProcessor( connections );
+    auto old_links = StateLinks( previous["states"] );
+    auto new_links = StateLinks( node["states"] );
+    
+    // candidates have the same class, options, connections and state links as before
+    for (auto & it : new_definitions) {
+        auto old = old_definitions.find( it.first );
+        if (old==old_definitions.end() || old->second!=it.second || engines_.count( it.first )==0) { continue; }
+        if (old_rules[it.first]!=new_rules[it.first] || old_links[it.first]!=new_links[it.first]) { continue; }
+        retained.insert( it.first );
+    }
+    
+    // stream connections to rebuilt processors are re-established on the
+    // ports of the kept processors (see RemoveProcessors), but processors
+    // that share a ring buffer (multiple producers), a thread (fused
+    // processors) or states cannot be attached to a rebuilt processor
+    std::map<std::string, std::set<std::string>> tied;
+    for (auto & it : connections_) {
+        std::string producer = it->out_address().processor();
+        std::string consumer = it->in_address().processor();
+        if (it->out_connector()->slot()->shared() || engines_[consumer].second->fused()) {
+            tied[producer].insert( consumer );
+            tied[consumer].insert( producer );
+        }
+    }
+    
+    std::map<std::string, std::set<std::string>> linked;
+    for (auto & it : new_links) {
+        for (auto & link : it.second) { linked[link].insert( it.first ); }
+    }
+    for (auto & it : linked) {
+        for (auto & name : it.second) { tied[name].insert( it.second.begin(), it.second.end() ); }
+    }
+    
+    // tied processors are kept or rebuilt together
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto it = retained.begin(); it!=retained.end(); ) {
+            auto & n = tied[*it];
+            if (std::all_of( n.begin(), n.end(), [&retained]( const std::string& name ) { return retained.count( name )>0; } )) {
+                ++it;
+            } else {
+                it = retained.erase( it );
+                changed = true;
+            }
+        }
+    }
+    
+    return retained;
+}
+
+void ProcessorGraph::RunPreparationStep( const std::string& step, const std::vector<std::string>& names,
+    const std::function<void(const std::string&, ProcessorEngine*)>& fn ) {
+    
+    std::vector<std::string> parallel;
+    std::vector<std::string> serial;
+    std::vector<std::function<void()>> tasks;
+    
+    for (auto & name : names) {
+        ProcessorEngine* engine = engines_[name].second.get();
+        if (prepare_workers_>1 && engine->processor()->parallel_prepare()) {
+            parallel.push_back( name );
+            tasks.push_back( [&fn, name, engine]() { fn( name, engine ); } );
+        } else {
+            serial.push_back( name );
+        }
+    }
+    
+    std::map<std::string, std::exception_ptr> errors;
+    
+    auto results = run_concurrently( tasks, prepare_workers_ );
+    for (unsigned int k=0; k<parallel.size(); ++k) {
+        if (results[k]) { errors[parallel[k]] = results[k]; }
+    }
+    
+    // processors that opt out run one after the other in this thread
+    for (auto & name : serial) {
+        try {
+            fn( name, engines_[name].second.get() );
+        } catch (...) {
+            errors[name] = std::current_exception();
+        }
+    }
+    
+    if (errors.empty()) { return; }
+    
+    // all failures are reported in processor order, the first one is rethrown
+    for (auto & it : errors) {
+        try {
+            std::rethrow_exception( it.second );
+        } catch (std::exception& e) {
+            LOG(ERROR) << step << " failed for processor " << it.first << ": " << e.what();
+        } catch (...) {
+            LOG(ERROR) << step << " failed for processor " << it.first << ".";
+        }
+    }
+    
+    std::rethrow_exception( errors.begin()->second );
+}
+
+std::vector<std::string> ProcessorGraph::ProcessorNames( const std::set<std::string>& exclude ) const {
+    
+    std::vector<std::string> names;
+    for (auto &it : this->engines_) {
+        if (exclude.count( it.first )==0) { names.push_back( it.first ); }
+    }
+    return names;
+}
+
+void ProcessorGraph::RemoveProcessors( const std::set<std::string>& retained ) {
+    
+    try {
+        RunPreparationStep( "Unprepare", ProcessorNames( retained ),
+            [this]( const std::string& name, ProcessorEngine* engine ) {
+                engine->processor()->Unprepare(global_context_);
+                LOG(DEBUG) << "Successfully unprepared processor " << name;
+            } );
+    } catch (...) {
+        Destroy();
+        throw InvalidGraphError("Error while unpreparing processors that are removed from the graph. Previous graph has been destroyed.");
+    }
+    
+    // connections between a kept and a removed processor are detached and
+    // re-established on the ports of the kept processor once the removed one
+    // is rebuilt; kept consumers were prepared for their current input stream
+    rewired_.clear();
+    for (auto &it : connections_) {
+        bool kept_producer = retained.count( it->out_address().processor() )>0;
+        bool kept_consumer = retained.count( it->in_address().processor() )>0;
+        if (kept_producer==kept_consumer) { continue; }
+        rewired_[it->string()] = kept_consumer ? it->in_connector()->slot()->UpstreamSignature() : "";
+        it->Disconnect();
+    }
+    
+    // only connections between retained processors remain
+    StreamConnections connections;
+    for (auto &it : connections_) {
+        if (retained.count( it->out_address().processor() )>0 && retained.count( it->in_address().processor() )>0) {
+            connections.push_back( std::move( it ) );
+        }
+    }
+    connections_ = std::move( connections );
+    
+    thread_groups_.clear();
+    cpu_placement_ = YAML::Node();
+    
+    for (auto it = engines_.begin(); it!=engines_.end(); ) {
+        if (retained.count( it->first )>0) {
+            it->second.second->reset_thread_core();
+            ++it;
+        } else {
+            it = engines_.erase( it );
+        }
+    }
+    
+    retained_ = retained;
+}
+
+bool ProcessorGraph::RewiredStreamsUnchanged() {
+    
+    for (auto &it : connections_) {
+        bool kept_producer = retained_.count( it->out_address().processor() )>0;
+        bool kept_consumer = retained_.count( it->in_address().processor() )>0;
+        if (kept_producer==kept_consumer) { continue; }
+        
+        auto old = rewired_.find( it->string() );
+        if (old==rewired_.end()) {
+            LOG(INFO) << "Connection " << it->string() << " was resolved to other slots than in the previous graph.";
+            return false;
+        }
+        if (kept_consumer && old->second!=it->in_connector()->slot()->UpstreamSignature()) {
+            LOG(INFO) << "Stream of connection " << it->string() << " differs from the previous graph.";
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void ProcessorGraph::UnprepareRetainedProcessors() {
+    
+    for (auto & name : retained_) {
+        try {
+            engines_[name].second->processor()->Unprepare(global_context_);
+        } catch (std::exception& e) {
+            LOG(WARNING) << "Error while unpreparing processor " << name << ": " << e.what();
+        }
+    }
+    retained_.clear();
+}
+
 void ProcessorGraph::Build( const YAML::Node& node ) {
     
-    if (state_!=GraphState::NOGRAPH) {
+    // a graph that is ready (but not processing) is rebuilt incrementally
+    if (state_!=GraphState::NOGRAPH && state_!=GraphState::READY) {
         throw InvalidStateError("A graph has already been built. Destroy old graph first.");
     }
     
@@ -293,37 +1015,91 @@ void ProcessorGraph::Build( const YAML::Node& node ) {
         throw InvalidGraphError("No processors found in graph definition.");
     }
     
+    StreamConnections connections;
+    std::set<std::string> retained;
+    
+    if (state_==GraphState::READY) {
+        // errors in the new definition leave the current graph untouched
+        if (node["connections"] && node["connections"].IsSequence()) {
+            ParseConnectionRules( node["connections"], connections );
+        }
+        
+        retained = RetainedProcessors( node, connections );
+        RemoveProcessors( retained );
+        
+        LOG(INFO) << "Rebuilding graph: keeping " << retained.size() << " unchanged processor(s).";
+    }
+    
     set_state( GraphState::CONSTRUCTING );
     
     try {
         
-        ConstructProcessorEngines( node["processors"], engines_, global_context_ );
+        // prepare_workers: N
+        // number of threads that prepare processors concurrently (1 disables)
+        prepare_workers_ = std::max( 1, node["prepare_workers"].as<int>( std::thread::hardware_concurrency() ) );
+        
+        ConstructProcessorEngines( node["processors"], engines_, global_context_, retained_ );
         LOG(INFO) << "Constructed and configured all processors";
         
+        ConstructThreadGroups();
+        
         for (auto &it : this->engines_) {
+            if (retained_.count( it.first )>0) { continue; }
             it.second.second->CreatePorts();
             LOG(DEBUG) << "Created ports for processor " << it.first;
         }
         LOG(INFO) << "All ports have been created.";
         
+        deadlines_.Configure( node["deadlines"] );
+        CreateDeadlineStates();
+        
         if (node["connections"] && node["connections"].IsSequence()) {
             
-            ParseConnectionRules( node["connections"], connections_ );
+            if (connections.empty()) {
+                ParseConnectionRules( node["connections"], connections );
+            }
             LOG(INFO) << "Parsed all connection rules.";
             
-            for ( auto &it : connections_ ) {
-                it->Connect( this->engines_ );
-                LOG(DEBUG) << "Established connection " << it->string();
+            // connections between retained processors are still established
+            StreamConnections previous = std::move( connections_ );
+            connections_.clear();
+            
+            for ( auto &it : connections ) {
+                auto old = previous.end();
+                if (retained_.count( it->out_address().processor() )>0 && retained_.count( it->in_address().processor() )>0) {
+                    std::string rule = it->rule();
+                    old = std::find_if( previous.begin(), previous.end(),
+                        [&rule]( const std::unique_ptr<StreamConnection>& c ) { return c && c->rule()==rule; } );
+                }
+                
+                if (old!=previous.end()) {
+                    connections_.push_back( std::move( *old ) );
+                    LOG(DEBUG) << "Kept connection " << connections_.back()->string();
+                } else {
+                    it->Connect( this->engines_ );
+                    LOG(DEBUG) << "Established connection " << it->string();
+                    connections_.push_back( std::move( it ) );
+                }
             }
             LOG(INFO) << "All connections have established.";
+            
+            // ring buffers of kept producers gate on the slots of rebuilt consumers
+            for (auto &it : connections_) {
+                if (retained_.count( it->out_address().processor() )>0 && retained_.count( it->in_address().processor() )==0) {
+                    it->out_connector()->slot()->UpdateGatingSequences();
+                }
+            }
         }
         
+        ConstructFusedChains();
+        
         if (node["states"] && node["states"].IsSequence()) {
             LinkSharedStates( node["states"] );
             LOG(INFO) << "Linked all shared states.";
         }
         
     } catch (...) {
+        UnprepareRetainedProcessors();
         Destroy();
         throw;
     }
@@ -337,33 +1113,81 @@ void ProcessorGraph::Build( const YAML::Node& node ) {
         }
         LOG(INFO) << "All data streams have been negotiated.";
         
+        realtime_profile_.Configure( node["realtime"] );
+        
+        // automatic placement needs the negotiated stream rates
+        if (node["cpu_placement"] && node["cpu_placement"].as<std::string>()=="auto") {
+            PlanCpuPlacement();
+        }
+        
+        // automatic ring sizing needs the negotiated stream rates
+        ring_sizing_.Configure( node["ring_sizing"] );
+        if (ring_sizing_.enabled()) {
+            AutoSizeRingBuffers();
+        }
+        
+        // ring buffer arenas are allocated on the NUMA node of the consumer
+        BindRingBuffersToNuma();
+        
         // build ringbuffers
-        for (auto &it : this->engines_) {
-            it.second.second->CreateRingBuffers();
-            LOG(DEBUG) << "Constructed ring buffer for processor " << it.first;
+        RunPreparationStep( "CreateRingBuffers", ProcessorNames( retained_ ),
+            []( const std::string& name, ProcessorEngine* engine ) {
+                engine->CreateRingBuffers();
+                LOG(DEBUG) << "Constructed ring buffer for processor " << name;
+            } );
+        
+        ring_sizing_report_ = YAML::Node( YAML::NodeType::Map );
+        for (auto &it : connections_) {
+            ISlotOut* slot = it->out_connector()->slot();
+            YAML::Node entry;
+            entry["size"] = slot->buffer_size();
+            entry["stream_rate"] = slot->streaminfo().stream_rate();
+            entry["fixed"] = it->out_connector()->port()->policy().fixed_buffer_size();
+            ring_sizing_report_[it->out_connector()->string()] = entry;
         }
         
+        ConfigureTracing( node["tracing"] );
+        
+        // monitoring needs the negotiated stream rates
+        ConfigureDeadlines();
+        
     } catch(...) {
+        UnprepareRetainedProcessors();
         Destroy();
         throw;
     }
     
+    // kept processors are not prepared again, so a rebuilt upstream processor
+    // needs to produce the same stream as before
+    if (!RewiredStreamsUnchanged()) {
+        LOG(INFO) << "Rebuilding the complete graph.";
+        UnprepareRetainedProcessors();
+        Destroy();
+        Build( node );
+        return;
+    }
+    
     set_state( GraphState::PREPARING );
     
     // prepare processors
     try {
-        for (auto &it : this->engines_) {
-            it.second.second->processor()->Prepare(global_context_);
-            LOG(DEBUG) << "Successfully prepared processor " << it.first;
-        }
+        RunPreparationStep( "Prepare", ProcessorNames( retained_ ),
+            [this]( const std::string& name, ProcessorEngine* engine ) {
+                engine->processor()->Prepare(global_context_);
+                LOG(DEBUG) << "Successfully prepared processor " << name;
+            } );
         LOG(INFO) << "All processors have been prepared.";
     } catch ( ... ) {
         
+        retained_.clear();
         Destroy();
         throw;
     }
     
-    yaml_ = node;
+    retained_.clear();
+    rewired_.clear();
+    // keep a copy: an assigned node shares its data with the caller's document
+    yaml_.reset( YAML::Clone( node ) );
     
     LOG(INFO) << "Graph was successfully constructed.";
     
@@ -383,12 +1207,14 @@ void ProcessorGraph::Destroy() {
     if (state_!=GraphState::CONSTRUCTING) {
         try {
             // unprepare processors
-            for (auto &it : this->engines_) {
-                it.second.second->processor()->Unprepare(global_context_);
-                LOG(DEBUG) << "Successfully unprepared processor " << it.first;
-            }
+            RunPreparationStep( "Unprepare", ProcessorNames(),
+                [this]( const std::string& name, ProcessorEngine* engine ) {
+                    engine->processor()->Unprepare(global_context_);
+                    LOG(DEBUG) << "Successfully unprepared processor " << name;
+                } );
         } catch (...) {
             connections_.clear();
+            thread_groups_.clear();
             engines_.clear();
             set_state(GraphState::NOGRAPH);
             throw InvalidGraphError("Error while unpreparing processors. Forced destruction of graph. Possible corruption of internal state.");
@@ -396,17 +1222,23 @@ void ProcessorGraph::Destroy() {
     }
     
     // destroy connections and processors
+    deadline_monitors_.clear();
+    deadline_flags_.clear();
     connections_.clear();
+    thread_groups_.clear();
+    cpu_placement_ = YAML::Node();
     engines_.clear();
+    retained_.clear();
+    rewired_.clear();
     
-    yaml_ = YAML::Null;
+    yaml_.reset();
     
     LOG(INFO) << "Graph has been destroyed.";
     
     set_state(GraphState::NOGRAPH);
 }
 
-void ProcessorGraph::StartProcessing( std::string run_group_id, std::string run_id, std::string template_id, bool test_flag ) {
+void ProcessorGraph::StartProcessing( std::string run_group_id, std::string run_id, std::string template_id, bool test_flag, bool offline ) {
     
     // start processing only if state is READY
     
@@ -415,9 +1247,17 @@ void ProcessorGraph::StartProcessing( std::string run_group_id, std::string run_
         // construct RunInfo object
         //runinfo_.reset( new RunInfo( terminate_signal_, context_, run_identifier, destination, source ) );
         run_context_.reset( new RunContext( global_context_, terminate_signal_, run_group_id, run_id, template_id, test_flag ) );
+        run_context_->offline_ = offline;
         
         set_state(GraphState::STARTING);
         
+        // lock memory before the threads are started, such that
+        // buffers allocated in Preprocess are locked as well
+        realtime_profile_.Apply();
+        if (realtime_profile_.enabled()) {
+            run_context_->realtime_profile = &realtime_profile_;
+        }
+        
         // prepare all processors for processing
         // (i.e. flush buffers)
         for ( auto& it : this->engines_ ) {
@@ -426,12 +1266,31 @@ void ProcessorGraph::StartProcessing( std::string run_group_id, std::string run_
         }
         LOG(INFO) << "Prepared all data stream ports for processing.";
         
+        for (auto & monitor : deadline_monitors_) { monitor->Reset(); }
+        for (auto & flag : deadline_flags_) { flag.second->Reset(); }
+        
         try {
+            // offline runs replace the configured threading
+            offline_group_.reset();
+            if (offline) { ConstructOfflineGroup(); }
+            
             //loop through all processors
             for ( auto& it : this->engines_ ) {
-                it.second.second->Start(*run_context_);
+                ProcessorEngine* engine = it.second.second.get();
+                if (engine->fused()) { continue; }
+                if (offline_group_ ? offline_group_->contains( engine ) : !engine->thread_group().empty()) { continue; }
+                engine->Start(*run_context_);
                 LOG(DEBUG) << "Started thread for processor " << it.first;
             }
+            if (offline_group_) {
+                offline_group_->Start(*run_context_);
+                LOG(DEBUG) << "Started offline processor group";
+            } else {
+                for ( auto& it : this->thread_groups_ ) {
+                    it.second->Start(*run_context_);
+                    LOG(DEBUG) << "Started thread for processor group " << it.first;
+                }
+            }
             LOG(INFO) << "Started all processors.";
         } catch( ... ) {
             StopProcessing();
@@ -447,6 +1306,16 @@ void ProcessorGraph::StartProcessing( std::string run_group_id, std::string run_
             }
         }
         
+        // nothing is published before the go signal, so it is safe to touch the ring buffers
+        if (realtime_profile_.enabled() && realtime_profile_.prefault()) {
+            std::size_t npages = 0;
+            for (auto & it : connections_) {
+                npages += it->out_connector()->slot()->Prefault();
+            }
+            realtime_profile_.Report( "prefault_ring_buffers", "graph", true,
+                "touched " + std::to_string( npages ) + " pages in " + std::to_string( connections_.size() ) + " ring buffers" );
+        }
+        
         // all processors have either passed the preprocessing step
         // or have terminated with error, which will be dealt with in graphmanager::run
         // let's signal everyone to GO
@@ -486,8 +1355,20 @@ void ProcessorGraph::StopProcessing( ) {
         for ( auto& it : this->engines_ ) {
             it.second.second->Stop();
         }
+        for ( auto& it : this->thread_groups_ ) {
+            it.second->Stop();
+        }
+        if (offline_group_) {
+            offline_group_->Stop();
+            offline_group_.reset();
+        }
+        
+        realtime_profile_.Release();
         
         LOG(INFO) << "Stopped all processors.";
+        
+        RecommendRingSizes();
+        ReportDeadlines();
         LOG(INFO) << "Graph was processing for " << std::to_string( run_context_->seconds() ) << " seconds";
         
         run_context_.reset();
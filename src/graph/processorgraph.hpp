@@ -24,15 +24,20 @@
 #include <cstring>
 #include <memory>
 #include <map>
+#include <set>
+#include <functional>
+#include <string>
 #include <utility>
 
 #include "yaml-cpp/yaml.h"
 #include "g3log/src/g2log.hpp"
 
 #include "processorengine.hpp"
+#include "threadgroup.hpp"
 #include "graphexceptions.hpp"
 #include "connectionparser.hpp"
 #include "runinfo.hpp"
+#include "deadlines.hpp"
 
 namespace graph {
 
@@ -74,7 +79,7 @@ public:
     
     void Build( const YAML::Node& node);
     void Destroy();
-    void StartProcessing( std::string run_group_id, std::string run_id, std::string template_id, bool test_flag );
+    void StartProcessing( std::string run_group_id, std::string run_id, std::string template_id, bool test_flag, bool offline = false );
     void StopProcessing();
     void Update( YAML::Node& node );
     void Retrieve( YAML::Node& node );
@@ -90,14 +95,77 @@ public:
     const StreamConnections& connections() const { return connections_; }
 
     void LinkSharedStates( const YAML::Node& node );
+    
+    // incremental rebuild: processors of the current graph whose definition,
+    // connections and state links are unchanged in the new graph definition
+    std::set<std::string> RetainedProcessors( const YAML::Node& node, const StreamConnections& connections );
+    // unprepare and remove all processors that are not retained, and detach
+    // their connections from the retained processors
+    void RemoveProcessors( const std::set<std::string>& retained );
+    // true if the re-established connections of retained processors use the
+    // same slots and carry the same streams as before
+    bool RewiredStreamsUnchanged();
+    void UnprepareRetainedProcessors();
+    
+    // run a step (Prepare, Unprepare, CreateRingBuffers) for the named processors
+    // on up to prepare_workers_ threads; processors that opt out of parallel
+    // preparation run afterwards in the calling thread
+    void RunPreparationStep( const std::string& step, const std::vector<std::string>& names,
+        const std::function<void(const std::string&, ProcessorEngine*)>& fn );
+    std::vector<std::string> ProcessorNames( const std::set<std::string>& exclude = {} ) const;
+    
+    void ConstructThreadGroups();
+    void ConstructFusedChains();
+    void PlanCpuPlacement();
+    void BindRingBuffersToNuma();
+    void ConfigureTracing( const YAML::Node& node );
+    // behind_realtime states are created before the shared states are linked,
+    // monitors are attached once the stream rates are known
+    void CreateDeadlineStates();
+    void ConfigureDeadlines();
+    void ReportDeadlines();
+    
+    // size all ring buffers of the graph (automatic ring sizing only)
+    void AutoSizeRingBuffers();
+    // compare the peak backlog of the last run with the ring buffer sizes
+    void RecommendRingSizes();
+    
+    // processors ordered such that upstream processors come first
+    // (ties and cycles are resolved by processor name)
+    std::vector<ProcessorEngine*> TopologicalOrder();
+    void ConstructOfflineGroup();
+    
+    const YAML::Node& cpu_placement() const { return cpu_placement_; }
+    YAML::Node realtime_report() const { return realtime_profile_.ExportYAML(); }
+    const YAML::Node& ring_sizing_report() const { return ring_sizing_report_; }
+    
+    // retrieval statistics of all connected input slots, optionally reset afterwards
+    YAML::Node ExportSlotStats( bool reset = false );
+    // CPU time and context switches of all processing threads in the current or last run
+    YAML::Node ExportThreadUsage();
+    // deadline statistics of all monitored output slots in the current or last run
+    YAML::Node ExportDeadlines();
 
 private:
-    YAML::Node yaml_;
+    YAML::Node yaml_; // copy of the current graph definition
     
     GlobalContext& global_context_;
     
     ProcessorEngineMap engines_;
+    std::map<std::string, std::unique_ptr<ThreadGroup>> thread_groups_;
+    std::unique_ptr<ThreadGroup> offline_group_;
+    YAML::Node cpu_placement_;
+    RealtimeProfile realtime_profile_;
+    RingSizing ring_sizing_;
+    YAML::Node ring_sizing_report_; // per output slot: size, stream rate and last recommendation
+    std::vector<std::string> trace_hops_; // output slot addresses, indexed by hop identifier
+    Deadlines deadlines_;
+    std::vector<std::unique_ptr<DeadlineMonitor>> deadline_monitors_;
+    std::map<std::string, std::unique_ptr<DeadlineFlag>> deadline_flags_; // per processor
     StreamConnections connections_;
+    std::set<std::string> retained_; // processors kept from the previous graph while building
+    std::map<std::string, std::string> rewired_; // detached connection -> upstream signature (kept consumers)
+    unsigned int prepare_workers_ = 1;
     
     GraphState state_ = GraphState::NOGRAPH;
     
@@ -0,0 +1,209 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "realtime.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <alloca.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
+#include "g3log/src/g2log.hpp"
+
+namespace {
+
+std::string error_string( int error ) {
+    
+    return std::string( strerror( error ) ) + " (errno " + std::to_string( error ) + ")";
+}
+
+// grows the stack by the given number of bytes and touches every page
+__attribute__((noinline)) std::size_t prefault_stack( std::size_t bytes ) {
+    
+    volatile char* buffer = static_cast<volatile char*>( alloca( bytes ) );
+    std::size_t page = sysconf( _SC_PAGESIZE );
+    std::size_t npages = 0;
+    for (std::size_t k=0; k<bytes; k+=page) {
+        buffer[k] = 0;
+        ++npages;
+    }
+    return npages;
+}
+
+}
+
+std::size_t prefault_memory( void* begin, std::size_t bytes ) {
+    
+    if (begin==nullptr || bytes==0) { return 0; }
+    
+    std::size_t page = sysconf( _SC_PAGESIZE );
+    volatile char* p = static_cast<volatile char*>( begin );
+    std::size_t npages = 0;
+    
+    // write back the current value, such that the page is really faulted in
+    for (std::size_t k=0; k<bytes; k+=page) {
+        p[k] = p[k];
+        ++npages;
+    }
+    p[bytes-1] = p[bytes-1];
+    
+    return npages;
+}
+
+RealtimeProfile::~RealtimeProfile() {
+    
+    Release();
+}
+
+void RealtimeProfile::Configure( const YAML::Node& node ) {
+    
+    // nothing carries over from an earlier graph
+    enabled_ = false;
+    lock_memory_ = DEFAULT_LOCK_MEMORY;
+    prefault_ = DEFAULT_PREFAULT;
+    stack_prefault_ = DEFAULT_STACK_PREFAULT;
+    dma_latency_ = DEFAULT_DMA_LATENCY;
+    timer_slack_ = DEFAULT_TIMER_SLACK;
+    
+    if (!node) { return; }
+    
+    if (node.IsScalar()) {
+        enabled_ = node.as<bool>();
+    } else if (node.IsMap()) {
+        enabled_ = node["enabled"].as<bool>( true );
+        lock_memory_ = node["lock_memory"].as<bool>( lock_memory_ );
+        prefault_ = node["prefault"].as<bool>( prefault_ );
+        stack_prefault_ = node["stack_prefault"].as<std::size_t>( stack_prefault_/1024 ) * 1024;
+        dma_latency_ = node["dma_latency"].as<int>( dma_latency_ );
+        timer_slack_ = node["timer_slack"].as<unsigned long>( timer_slack_ );
+    } else {
+        throw std::runtime_error( "Invalid realtime profile definition." );
+    }
+}
+
+void RealtimeProfile::Apply() {
+    
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        report_ = YAML::Node( YAML::NodeType::Sequence );
+    }
+    
+    if (!enabled_) { return; }
+    
+    if (lock_memory_) {
+        if (mlockall( MCL_CURRENT | MCL_FUTURE )==0) {
+            memory_locked_ = true;
+            Report( "lock_memory", "process", true, "locked current and future memory" );
+        } else {
+            Report( "lock_memory", "process", false, "mlockall failed: " + error_string( errno ) );
+        }
+    }
+    
+    if (dma_latency_>=0) {
+        dma_latency_fd_ = open( "/dev/cpu_dma_latency", O_RDWR );
+        if (dma_latency_fd_<0) {
+            Report( "dma_latency", "process", false, "cannot open /dev/cpu_dma_latency: " + error_string( errno ) );
+        } else {
+            int32_t value = dma_latency_;
+            if (write( dma_latency_fd_, &value, sizeof(value) )!=sizeof(value)) {
+                Report( "dma_latency", "process", false, "cannot write /dev/cpu_dma_latency: " + error_string( errno ) );
+                close( dma_latency_fd_ );
+                dma_latency_fd_ = -1;
+            } else {
+                Report( "dma_latency", "process", true, "holding cpu dma latency at " + std::to_string( dma_latency_ ) + " us" );
+            }
+        }
+    }
+}
+
+void RealtimeProfile::Release() {
+    
+    if (dma_latency_fd_>=0) {
+        // the latency request is dropped when the file is closed
+        close( dma_latency_fd_ );
+        dma_latency_fd_ = -1;
+        LOG(INFO) << "Released cpu dma latency request.";
+    }
+    
+    if (memory_locked_) {
+        munlockall();
+        memory_locked_ = false;
+        LOG(INFO) << "Unlocked process memory.";
+    }
+}
+
+void RealtimeProfile::PrepareThread( std::string name, bool realtime_thread ) {
+    
+    if (!enabled_) { return; }
+    
+    if (prefault_ && stack_prefault_>0) {
+        std::size_t npages = prefault_stack( stack_prefault_ );
+        Report( "prefault_stack", name, true, "touched " + std::to_string( npages ) + " stack pages" );
+    }
+    
+    if (timer_slack_>0) {
+        if (!realtime_thread) {
+            Report( "timer_slack", name, true, "skipped, thread has no realtime priority" );
+        } else if (prctl( PR_SET_TIMERSLACK, timer_slack_, 0, 0, 0 )==0) {
+            Report( "timer_slack", name, true, "set to " + std::to_string( timer_slack_ ) + " ns" );
+        } else {
+            Report( "timer_slack", name, false, "prctl failed: " + error_string( errno ) );
+        }
+    }
+}
+
+void RealtimeProfile::Report( std::string step, std::string target, bool ok, std::string message ) {
+    
+    if (ok) {
+        LOG(INFO) << "Realtime profile: " << step << " (" << target << "): " << message;
+    } else {
+        LOG(WARNING) << "Realtime profile: " << step << " (" << target << ") failed: " << message;
+    }
+    
+    YAML::Node entry;
+    entry["step"] = step;
+    entry["target"] = target;
+    entry["ok"] = ok;
+    entry["message"] = message;
+    
+    std::lock_guard<std::mutex> lock( mutex_ );
+    report_.push_back( entry );
+}
+
+YAML::Node RealtimeProfile::ExportYAML() const {
+    
+    std::lock_guard<std::mutex> lock( mutex_ );
+    
+    YAML::Node node;
+    node["enabled"] = enabled_;
+    if (enabled_) {
+        node["lock_memory"] = lock_memory_;
+        node["prefault"] = prefault_;
+        node["stack_prefault"] = stack_prefault_/1024;
+        node["dma_latency"] = dma_latency_;
+        node["timer_slack"] = timer_slack_;
+        node["report"] = YAML::Clone( report_ );
+    }
+    return node;
+}
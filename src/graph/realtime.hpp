@@ -0,0 +1,95 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+#include "yaml-cpp/yaml.h"
+
+/* RealtimeProfile: opt-in host hardening for the duration of a run
+ * 
+ * Enabled with the realtime key in the graph definition, either as
+ * "realtime: true" (all defaults) or as a map:
+ * 
+ *   realtime:
+ *       lock_memory: true      # mlockall(MCL_CURRENT|MCL_FUTURE)
+ *       prefault: true         # touch all ring buffer items and thread stacks
+ *       stack_prefault: 256    # KiB of stack to pre-fault in each thread
+ *       dma_latency: 0         # hold /dev/cpu_dma_latency at this value (us), -1 disables
+ *       timer_slack: 1         # timer slack (ns) of realtime threads, 0 disables
+ * 
+ * Memory is locked before the processor threads are started, such that
+ * scratch buffers that processors allocate in Preprocess are locked and
+ * faulted in as well. Every step records its outcome in a report, which is
+ * also logged.
+ */
+class RealtimeProfile {
+public:
+    RealtimeProfile() = default;
+    ~RealtimeProfile();
+    
+    RealtimeProfile( const RealtimeProfile& ) = delete;
+    RealtimeProfile& operator=( const RealtimeProfile& ) = delete;
+    
+    void Configure( const YAML::Node& node );
+    bool enabled() const { return enabled_; }
+    bool prefault() const { return prefault_; }
+    
+    // process wide steps, called before the processor threads are started
+    void Apply();
+    // undo process wide steps, called after all processor threads have joined
+    void Release();
+    
+    // per thread steps, called in each processor thread before Preprocess
+    void PrepareThread( std::string name, bool realtime_thread );
+    
+    // record the outcome of a step (thread-safe)
+    void Report( std::string step, std::string target, bool ok, std::string message );
+    
+    YAML::Node ExportYAML() const;
+    
+    static const bool DEFAULT_LOCK_MEMORY = true;
+    static const bool DEFAULT_PREFAULT = true;
+    static const std::size_t DEFAULT_STACK_PREFAULT = 256*1024; // bytes
+    static const int DEFAULT_DMA_LATENCY = 0; // us
+    static const unsigned long DEFAULT_TIMER_SLACK = 1; // ns
+    
+protected:
+    bool enabled_ = false;
+    bool lock_memory_ = DEFAULT_LOCK_MEMORY;
+    bool prefault_ = DEFAULT_PREFAULT;
+    std::size_t stack_prefault_ = DEFAULT_STACK_PREFAULT;
+    int dma_latency_ = DEFAULT_DMA_LATENCY;
+    unsigned long timer_slack_ = DEFAULT_TIMER_SLACK;
+    
+    bool memory_locked_ = false;
+    int dma_latency_fd_ = -1;
+    
+    mutable std::mutex mutex_;
+    YAML::Node report_;
+};
+
+// touch every page in a memory range, returns the number of pages
+std::size_t prefault_memory( void* begin, std::size_t bytes );
+
+#endif // realtime.hpp
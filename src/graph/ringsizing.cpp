@@ -0,0 +1,75 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "ringsizing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "../data/idata.hpp"
+#include "utilities/math_numeric.hpp"
+
+void RingSizing::Configure( const YAML::Node& node ) {
+    
+    // nothing carries over from an earlier graph
+    enabled_ = false;
+    max_stall_ = DEFAULT_MAX_STALL;
+    min_size_ = DEFAULT_MIN_SIZE;
+    max_size_ = DEFAULT_MAX_SIZE;
+    
+    if (!node) { return; }
+    
+    if (node.IsScalar()) {
+        std::string value = node.as<std::string>();
+        if (value=="auto") {
+            enabled_ = true;
+        } else if (value!="manual") {
+            throw std::runtime_error( "Invalid ring sizing mode \"" + value + "\" (should be auto or manual)." );
+        }
+    } else if (node.IsMap()) {
+        enabled_ = node["enabled"].as<bool>( true );
+        max_stall_ = node["max_stall"].as<double>( max_stall_ );
+        min_size_ = node["min_size"].as<int>( min_size_ );
+        max_size_ = node["max_size"].as<int>( max_size_ );
+    } else {
+        throw std::runtime_error( "Invalid ring sizing definition." );
+    }
+    
+    if (max_stall_<=0) {
+        throw std::runtime_error( "Ring sizing max_stall should be larger than zero." );
+    }
+    if (min_size_<2 || max_size_<min_size_) {
+        throw std::runtime_error( "Ring sizing should satisfy 2 <= min_size <= max_size." );
+    }
+}
+
+int RingSizing::size_for_rate( double rate ) const {
+    
+    if (rate<=IRREGULARSTREAM) { return 0; }
+    
+    double n = std::ceil( rate * max_stall_ / 1000.0 );
+    return static_cast<int>( std::min( std::max( n, (double) min_size_ ), (double) max_size_ ) );
+}
+
+int RingSizing::recommend( uint64_t peak_backlog ) const {
+    
+    double n = std::ceil( peak_backlog * HEADROOM );
+    return next_pow2( static_cast<int>( std::min( std::max( n, (double) min_size_ ), (double) max_size_ ) ) );
+}
@@ -0,0 +1,72 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#ifndef RINGSIZING_H
+#define RINGSIZING_H
+
+#include <cstdint>
+
+#include "yaml-cpp/yaml.h"
+
+/* RingSizing: ring buffer sizes derived from the stream rate
+ * 
+ * Enabled with the ring_sizing key in the graph definition, either as
+ * "ring_sizing: auto" (all defaults) or as a map:
+ * 
+ *   ring_sizing:
+ *       max_stall: 50      # consumer stall (ms) that a ring buffer absorbs
+ *       min_size: 16       # lower bound of the number of slots
+ *       max_size: 65536    # upper bound of the number of slots
+ * 
+ * Each output port is sized to hold max_stall ms of its fastest stream
+ * (rounded up to a power of two when the ring buffer is created). Ports
+ * with an explicit size (advanced: buffer_sizes) and ports with irregular
+ * streams keep their size.
+ * 
+ * Independent of automatic sizing, the peak backlog that was observed in
+ * each ring buffer during a run is turned into a size recommendation when
+ * the run ends.
+ */
+class RingSizing {
+public:
+    void Configure( const YAML::Node& node );
+    bool enabled() const { return enabled_; }
+    double max_stall() const { return max_stall_; }
+    
+    // number of slots that holds max_stall ms of a stream with the given
+    // rate (items per second), or 0 if the rate is not known
+    int size_for_rate( double rate ) const;
+    
+    // number of slots that holds the peak backlog with some headroom
+    int recommend( uint64_t peak_backlog ) const;
+    
+    const double HEADROOM = 2.0;
+    
+    static constexpr double DEFAULT_MAX_STALL = 50.0; // ms
+    static const int DEFAULT_MIN_SIZE = 16;
+    static const int DEFAULT_MAX_SIZE = 65536;
+    
+protected:
+    bool enabled_ = false;
+    double max_stall_ = DEFAULT_MAX_STALL;
+    int min_size_ = DEFAULT_MIN_SIZE;
+    int max_size_ = DEFAULT_MAX_SIZE;
+};
+
+#endif // ringsizing.hpp
@@ -33,6 +33,7 @@
 #include <condition_variable>
 
 #include "../context.hpp"
+#include "realtime.hpp"
 #include "g3log/src/g2log.hpp"
 #include "utilities/time.hpp"
 
@@ -47,6 +48,7 @@ public:
 
 friend class graph::ProcessorGraph;
 friend class ProcessorEngine;
+friend class ThreadGroup;
 
 public:
     RunContext( GlobalContext& context, std::atomic<bool>& terminate_signal, std::string run_group_id, std::string run_id, std::string template_id, bool test_flag ) :
@@ -153,10 +155,15 @@ public:
     
     bool test() const { return default_test_flag_.load(); }
     
+    // offline runs process recorded data as fast as possible (no real-time pacing)
+    bool offline() const { return offline_; }
+    
 protected:
     std::mutex mutex;
     std::condition_variable go_condition;
     bool go_signal = false;
+    RealtimeProfile* realtime_profile = nullptr;
+    bool offline_ = false;
 
 private:
     GlobalContext& global_context_;
@@ -214,6 +221,7 @@ public:
     RunContext& run() { return run_context_; }
     
     bool test() const { return test_flag_.load(); }
+    bool offline() const { return run_context_.offline(); }
     
     bool terminated() const { return run_context_.terminated(); }
     void Terminate() { run_context_.Terminate(); }
@@ -0,0 +1,157 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "slotstats.hpp"
+
+void LogHistogram::Reset() {
+    
+    for (auto & bucket : buckets_) {
+        bucket.store( 0, std::memory_order_relaxed );
+    }
+    count_.store( 0, std::memory_order_relaxed );
+    sum_.store( 0, std::memory_order_relaxed );
+    max_.store( 0, std::memory_order_relaxed );
+}
+
+uint64_t LogHistogram::quantile( double fraction ) const {
+    
+    uint64_t n = count();
+    if (n==0) { return 0; }
+    
+    uint64_t target = static_cast<uint64_t>( fraction * n );
+    uint64_t cumulative = 0;
+    
+    for (unsigned int k=0; k<NBUCKETS; ++k) {
+        cumulative += buckets_[k].load( std::memory_order_relaxed );
+        if (cumulative > target) {
+            return k==0 ? 0 : (k==64 ? UINT64_MAX : (uint64_t(1) << k) - 1);
+        }
+    }
+    
+    return max();
+}
+
+YAML::Node LogHistogram::ExportYAML() const {
+    
+    YAML::Node node;
+    uint64_t n = count();
+    
+    node["count"] = n;
+    node["mean"] = n==0 ? 0.0 : static_cast<double>( sum() ) / n;
+    node["max"] = max();
+    node["p50"] = quantile( 0.5 );
+    node["p99"] = quantile( 0.99 );
+    node["p999"] = quantile( 0.999 );
+    
+    // non-empty buckets, as [upper bound (inclusive), count]
+    YAML::Node buckets( YAML::NodeType::Sequence );
+    for (unsigned int k=0; k<NBUCKETS; ++k) {
+        uint64_t c = buckets_[k].load( std::memory_order_relaxed );
+        if (c==0) { continue; }
+        YAML::Node bucket;
+        bucket.push_back( k==0 ? 0 : (k==64 ? UINT64_MAX : (uint64_t(1) << k) - 1) );
+        bucket.push_back( c );
+        bucket.SetStyle( YAML::EmitterStyle::Flow );
+        buckets.push_back( bucket );
+    }
+    node["buckets"] = buckets;
+    
+    return node;
+}
+
+void TraceStats::Record( const DataTrace& trace, TimePoint retrieved ) {
+    
+    std::vector<uint32_t> path( trace.nstamps );
+    for (unsigned int k=0; k<trace.nstamps; ++k) {
+        path[k] = trace.stamps[k].hop;
+    }
+    
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>( retrieved.time_since_epoch() ).count();
+    
+    std::lock_guard<std::mutex> guard( lock_ );
+    
+    // one histogram per interval between stamps, one for the interval
+    // between the last stamp and retrieval and one for the total
+    PathHistograms & histograms = paths_[path];
+    if (histograms.empty()) {
+        for (unsigned int k=0; k<trace.nstamps+1; ++k) {
+            histograms.emplace_back( new LogHistogram() );
+        }
+    }
+    
+    auto interval = []( int64_t a, int64_t b ) { return static_cast<uint64_t>( b>a ? b-a : 0 ); };
+    
+    for (unsigned int k=1; k<trace.nstamps; ++k) {
+        histograms[k-1]->Record( interval( trace.stamps[k-1].time, trace.stamps[k].time ) );
+    }
+    histograms[trace.nstamps-1]->Record( interval( trace.stamps[trace.nstamps-1].time, now ) );
+    histograms[trace.nstamps]->Record( interval( trace.stamps[0].time, now ) );
+}
+
+void TraceStats::Reset() {
+    
+    std::lock_guard<std::mutex> guard( lock_ );
+    paths_.clear();
+}
+
+YAML::Node TraceStats::ExportYAML( const std::vector<std::string>& hop_names ) const {
+    
+    YAML::Node node( YAML::NodeType::Sequence );
+    
+    auto hop_name = [&hop_names]( uint32_t hop ) {
+        return hop < hop_names.size() ? hop_names[hop] : std::to_string( hop );
+    };
+    
+    std::lock_guard<std::mutex> guard( lock_ );
+    
+    for (auto & it : paths_) {
+        YAML::Node path;
+        const std::vector<uint32_t> & hops = it.first;
+        
+        // the first stamp is the claim in the source, the latency of every
+        // following hop runs from the previous stamp to its publication
+        path["source"] = hop_name( hops[0] );
+        for (unsigned int k=1; k<hops.size(); ++k) {
+            YAML::Node hop;
+            hop["hop"] = hop_name( hops[k] );
+            hop["latency_ns"] = it.second[k-1]->ExportYAML();
+            path["hops"].push_back( hop );
+        }
+        path["retrieval_ns"] = it.second[hops.size()-1]->ExportYAML();
+        path["total_ns"] = it.second[hops.size()]->ExportYAML();
+        node.push_back( path );
+    }
+    
+    return node;
+}
+
+YAML::Node SlotStats::ExportYAML( const std::vector<std::string>& hop_names ) const {
+    
+    YAML::Node node;
+    node["backlog"] = backlog.ExportYAML();
+    node["wait_ns"] = wait_ns.ExportYAML();
+    node["age_ns"] = age_ns.ExportYAML();
+    node["dropped"] = dropped.load( std::memory_order_relaxed );
+    node["overwritten"] = overwritten.load( std::memory_order_relaxed );
+    
+    YAML::Node paths = traces.ExportYAML( hop_names );
+    if (paths.size()>0) { node["traces"] = paths; }
+    
+    return node;
+}
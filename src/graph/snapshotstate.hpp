@@ -0,0 +1,353 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#ifndef SNAPSHOTSTATE_H
+#define SNAPSHOTSTATE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <stdexcept>
+
+#include "sharedstate.hpp"
+
+/* SnapshotStore: versioned store for an immutable object of any type
+ *
+ * A single writer publishes new versions of the object by swapping a pointer;
+ * readers acquire the current version wait-free (one store, two loads) and can
+ * keep using it until they release it, even if newer versions are published
+ * in the meantime.
+ *
+ * Replaced versions are reclaimed by the writer with epoch-based reclamation.
+ * Every reader owns a record (on its own cache line) in which it announces
+ * the global epoch while it holds a version. A version that was replaced in
+ * epoch e can be deleted as soon as no reader announces an epoch <= e, since
+ * any reader that announced a later epoch loaded the pointer after the swap.
+ * Readers never write shared data other than their own record and never wait
+ * for the writer; the writer never waits for readers.
+ */
+
+// called on a new version right before it is published, while the writer
+// still owns it; types with lazily computed members provide an overload that
+// completes them, since readers only get const access
+template <typename T>
+inline void PrepareSnapshot( T& ) {}
+
+template <typename T>
+class SnapshotStore {
+public:
+    static const unsigned int MAX_READERS = 64;
+    
+    SnapshotStore() : current_(nullptr), epoch_(1) {}
+    
+    ~SnapshotStore() {
+        
+        delete current_.load();
+        for (auto & item : retired_) {
+            delete item.first;
+        }
+    }
+    
+    SnapshotStore( const SnapshotStore& ) = delete;
+    SnapshotStore& operator=( const SnapshotStore& ) = delete;
+    
+    // reader registration happens at graph build time, not while processing
+    unsigned int RegisterReader() {
+        
+        for (unsigned int k=0; k<MAX_READERS; ++k) {
+            bool expected = false;
+            if (records_[k].used.compare_exchange_strong( expected, true )) {
+                records_[k].depth = 0;
+                return k;
+            }
+        }
+        throw std::runtime_error( "Too many readers of a snapshot state." );
+    }
+    
+    void UnregisterReader( unsigned int reader ) {
+        
+        records_[reader].epoch.store( 0 );
+        records_[reader].used.store( false );
+    }
+    
+    // acquire/release may be nested, the outermost acquire protects all
+    // versions that are acquired until the matching release
+    const T* Acquire( unsigned int reader ) {
+        
+        auto & record = records_[reader];
+        if (record.depth++ == 0) {
+            // the announcement has to be visible before the pointer is read
+            record.epoch.store( epoch_.load() );
+        }
+        return current_.load();
+    }
+    
+    void Release( unsigned int reader ) {
+        
+        auto & record = records_[reader];
+        if (--record.depth == 0) {
+            record.epoch.store( 0, std::memory_order_release );
+        }
+    }
+    
+    // for the writer only
+    void Publish( std::unique_ptr<T> value ) {
+        
+        if (value) { PrepareSnapshot( *value ); }
+        const T* old = current_.exchange( value.release() );
+        uint64_t epoch = epoch_.fetch_add( 1 );
+        if (old != nullptr) {
+            retired_.emplace_back( old, epoch );
+        }
+        Reclaim();
+    }
+    
+    // for the writer only: the writer never reclaims the current version
+    const T* current() const { return current_.load( std::memory_order_relaxed ); }
+    
+    uint64_t version() const { return epoch_.load() - 1; }
+    
+    std::size_t nretired() const { return retired_.size(); }
+    
+    void Reclaim() {
+        
+        if (retired_.empty()) { return; }
+        
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for (auto & record : records_) {
+            uint64_t epoch = record.epoch.load();
+            if (epoch != 0 && epoch < oldest) { oldest = epoch; }
+        }
+        
+        auto keep = retired_.begin();
+        for (auto it = retired_.begin(); it != retired_.end(); ++it) {
+            if (it->second < oldest) {
+                delete it->first;
+            } else {
+                *keep++ = *it;
+            }
+        }
+        retired_.erase( keep, retired_.end() );
+    }
+    
+protected:
+    // padded to a cache line, such that readers do not share lines (the
+    // store is heap allocated, so alignas would not be honoured in C++11)
+    struct ReaderRecord {
+        std::atomic<uint64_t> epoch{0}; // 0 = not holding a version
+        std::atomic<bool> used{false};
+        unsigned int depth = 0; // only touched by the reader
+        char padding[64 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<bool>) - sizeof(unsigned int)];
+    };
+    
+    std::atomic<const T*> current_;
+    std::atomic<uint64_t> epoch_;
+    char padding_[64];
+    ReaderRecord records_[MAX_READERS];
+    std::vector<std::pair<const T*,uint64_t>> retired_;
+};
+
+/* Snapshot: scoped read access to one version of a snapshot state
+ *
+ * The version stays valid for as long as the snapshot exists (e.g. for the
+ * processing of one bin of data). The snapshot is empty (nullptr) if nothing
+ * was published yet.
+ */
+template <typename T>
+class Snapshot {
+public:
+    Snapshot() : store_(nullptr), reader_(0), value_(nullptr) {}
+    
+    Snapshot( SnapshotStore<T>* store, unsigned int reader ) :
+    store_(store), reader_(reader), value_(store->Acquire(reader)) {}
+    
+    Snapshot( Snapshot&& other ) : store_(other.store_), reader_(other.reader_), value_(other.value_) {
+        
+        other.store_ = nullptr;
+        other.value_ = nullptr;
+    }
+    
+    Snapshot& operator=( Snapshot&& other ) {
+        
+        if (this != &other) {
+            release();
+            store_ = other.store_;
+            reader_ = other.reader_;
+            value_ = other.value_;
+            other.store_ = nullptr;
+            other.value_ = nullptr;
+        }
+        return *this;
+    }
+    
+    Snapshot( const Snapshot& ) = delete;
+    Snapshot& operator=( const Snapshot& ) = delete;
+    
+    ~Snapshot() { release(); }
+    
+    void release() {
+        
+        if (store_ != nullptr) {
+            store_->Release( reader_ );
+            store_ = nullptr;
+            value_ = nullptr;
+        }
+    }
+    
+    const T* get() const { return value_; }
+    const T* operator->() const { return value_; }
+    const T& operator*() const { return *value_; }
+    explicit operator bool() const { return value_ != nullptr; }
+    
+protected:
+    SnapshotStore<T>* store_;
+    unsigned int reader_;
+    const T* value_;
+};
+
+/* SnapshotState: shared state for immutable objects that do not fit in a
+ * std::atomic (e.g. models, threshold vectors, channel masks)
+ *
+ * Only a single processor may write the state: the writable state requires
+ * peers that can only read. Externally, the state can only be inspected: the
+ * string value is the version number of the published object.
+ */
+template <typename T>
+class SnapshotState : public IState {
+public:
+    SnapshotState( Permissions permissions, std::string units="", std::string description="" ) :
+    IState(permissions, units, description), store_(new SnapshotStore<T>()) {
+        
+        shared_store_ = store_.get();
+        if (permissions_.self()==Permission::READ) {
+            own_reader_ = reader_ = store_->RegisterReader();
+        }
+    }
+    
+    virtual bool IsCompatible( const IState* other ) override {
+        
+        auto cast = dynamic_cast<const SnapshotState<T>*>( other );
+        if (cast) {
+            return permissions_.IsCompatible( cast->permissions() );
+        } else { return false; }
+    }
+    
+    virtual void Share( IState* master ) override {
+        
+        if ( IsMaster() ) {
+            throw std::runtime_error( "Internal error. Attempting to reshare master." );
+        }
+        
+        auto cast = dynamic_cast<SnapshotState<T>*>( master );
+        if (!cast) {
+            throw std::runtime_error( "Internal error. Bad cast!!" );
+        }
+        
+        // re-sharing with the same master (incremental rebuild) keeps the record
+        if (cast->shared_store() == shared_store_) { return; }
+        
+        if (permissions_.self()==Permission::READ) {
+            reader_ = cast->shared_store()->RegisterReader();
+        }
+        shared_store_ = cast->shared_store();
+    }
+    
+    virtual void Unshare() override {
+        
+        shared_store_ = store_.get();
+        reader_ = own_reader_;
+    }
+    
+protected:
+    SnapshotStore<T>* shared_store() { return shared_store_; }
+    
+    // only for external control
+    virtual std::string get_string() const override {
+        
+        return std::to_string( shared_store_->version() );
+    }
+    virtual bool set_string( std::string & value ) override {
+        
+        return false;
+    }
+    
+protected:
+    std::unique_ptr<SnapshotStore<T>> store_;
+    SnapshotStore<T>* shared_store_ = nullptr;
+    unsigned int own_reader_ = 0;
+    unsigned int reader_ = 0;
+};
+
+template <typename T>
+class ReadableSnapshotState : public SnapshotState<T> {
+public:
+    ReadableSnapshotState( Permission peers = Permission::WRITE, Permission external = Permission::NONE ) : SnapshotState<T>( Permissions( Permission::READ, peers, external ) ) {}
+    ReadableSnapshotState( std::string units, std::string description="", Permission peers = Permission::WRITE, Permission external = Permission::NONE ) : SnapshotState<T>( Permissions( Permission::READ, peers, external ), units, description ) {}
+    
+    // to be called from the processing thread of the owning processor
+    Snapshot<T> acquire() {
+        
+        return Snapshot<T>( this->shared_store_, this->reader_ );
+    }
+};
+
+template <typename T>
+class WritableSnapshotState : public SnapshotState<T> {
+public:
+    WritableSnapshotState( Permission peers = Permission::READ, Permission external = Permission::NONE ) : SnapshotState<T>( Permissions( Permission::WRITE, peers, external ) ) {
+        
+        check_single_writer();
+    }
+    WritableSnapshotState( std::string units, std::string description="", Permission peers = Permission::READ, Permission external = Permission::NONE ) : SnapshotState<T>( Permissions( Permission::WRITE, peers, external ), units, description ) {
+        
+        check_single_writer();
+    }
+    
+    const T* get() const {
+        
+        return this->shared_store_->current();
+    }
+    
+    void publish( std::unique_ptr<T> value ) {
+        
+        this->shared_store_->Publish( std::move(value) );
+    }
+    void publish( T value ) {
+        
+        publish( std::unique_ptr<T>( new T( std::move(value) ) ) );
+    }
+    
+    // delete versions that were released by all readers since the last publish
+    void reclaim() {
+        
+        this->shared_store_->Reclaim();
+    }
+    
+protected:
+    void check_single_writer() {
+        
+        if (this->permissions_.others()==Permission::WRITE) {
+            throw std::runtime_error( "Snapshot states support a single writer only." );
+        }
+    }
+};
+
+#endif // snapshotstate.hpp
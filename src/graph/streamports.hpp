@@ -22,6 +22,8 @@
 
 #include "istreamports.hpp"
 #include "connections.hpp"
+#include "dataview.hpp"
+#include "realtime.hpp"
 #include <set>
 
 struct RingBufferStatus {
@@ -60,29 +62,52 @@ public:
     
     uint64_t nitems_produced() const;
     
+    virtual bool HasCapacity() const override { return !connected() || ringbuffer_->HasAvalaibleCapacity(); }
+    
+    virtual std::size_t Prefault() override;
+    
+    virtual bool PublishWithoutSignal() override;
+    virtual void SignalPublished() override;
+    virtual void Reclose() override;
+    virtual void UpdateGatingSequences() override;
+    
 protected:
+    // complete the claimed items before they are shared with consumers
+    void prepare_publication();
+    
 	// called by SlotIn<DATATYPE>
     virtual typename DATATYPE::DATACLASS* DataAt( int64_t sequence ) const { return ringbuffer_->Get( sequence ); }
     
-    void CreateRingBuffer(int buffer_size, WaitStrategy wait_strategy);
+    void CreateRingBuffer(int buffer_size, WaitStrategy wait_strategy, const WaitParameters& wait_parameters,
+        ItemAllocation allocation = ItemAllocation::HEAP);
     void Unlock();
     
     RingBatch* next_batch( uint64_t n = 1 );
 	
+    // called by owner of a shared ring buffer
+    void AttachRingBuffer( SlotOut<DATATYPE>* owner );
+	
 	virtual void PrepareProcessing() {
         
         ringbuffer_serial_number_ = 0;
+        npublished_.store( 0, std::memory_order_relaxed );
         
         if (!connected()) {return;}
         
+        ResetProducers();
+        
+        // the owner resets the shared ring buffer
+        if (owner()!=this) {return;}
+        
         ringbuffer_->ForcePublish( -1L );
         ringbuffer_->Claim( -1L );
     }
     
 public:
     StreamInfo<DATATYPE> streaminfo_; // owned by SlotOut, once finalized, the streaminfo (and datatype) are fixed for the life time of the slot(?)
-    std::unique_ptr< DataFactory<DATATYPE> > datafactory_ = nullptr;
-    std::unique_ptr< RingBuffer<typename DATATYPE::DATACLASS> > ringbuffer_ = nullptr;
+    // shared with co-producers for multi-producer slots
+    std::shared_ptr< DataFactory<DATATYPE> > datafactory_ = nullptr;
+    std::shared_ptr< RingBuffer<typename DATATYPE::DATACLASS> > ringbuffer_ = nullptr;
 
 protected:
     uint64_t ringbuffer_serial_number_;
@@ -135,7 +160,8 @@ class SlotIn : public ISlotIn {
 friend class PortIn<DATATYPE>;
 
 public:
-    SlotIn( DATATYPE datatype, int64_t time_out = -1, bool cache = false ) : ISlotIn(time_out,cache), datatype_(datatype) {}
+    SlotIn( DATATYPE datatype, int64_t time_out = -1, bool cache = false, bool lossy = false ) :
+    ISlotIn(time_out,cache,lossy), datatype_(datatype) {}
 	
 	// methods called by processor implementation
     const typename DATATYPE::DATACLASS* GetDataPrototype() const;
@@ -143,6 +169,10 @@ public:
     bool RetrieveDataN( uint64_t n, std::vector<typename DATATYPE::DATACLASS*> & data );
     bool RetrieveDataAll( std::vector<typename DATATYPE::DATACLASS*> & data );
     
+    // allocation-free alternatives that return a view on the ring buffer
+    bool RetrieveDataN( uint64_t n, DataView<typename DATATYPE::DATACLASS> & data );
+    bool RetrieveDataAll( DataView<typename DATATYPE::DATACLASS> & data );
+    
     StreamInfo<DATATYPE>& streaminfo() {
         if (!connected()) {
             throw std::runtime_error( "Input slot is not connected" );
@@ -159,6 +189,8 @@ protected:
     void Unlock();
     void check_high_water_level();
     
+    void assign_view( DataView<typename DATATYPE::DATACLASS> & data, int64_t first, int64_t last );
+    
     RingBufferStatus status_;
     
     const double HIGH_WATER_LEVEL = 0.85;
@@ -185,6 +217,8 @@ public:
     
     virtual const AnyDataType& datatype() const override { return datatype_; }
     
+    virtual bool lossy_compatible() const override { return DATATYPE::DATACLASS::FIXED_PAYLOAD; }
+    
     StreamInfo<DATATYPE>& streaminfo( std::size_t index ) { return slots_[index]->streaminfo(); }
     
     virtual void PrepareProcessing() override {
@@ -35,6 +35,8 @@ inline typename DATATYPE::DATACLASS* SlotOut<DATATYPE>::ClaimData( bool clear )
     typename DATATYPE::DATACLASS* data = ringbuffer_->Get( ring_batch_.Start() );
     if (clear) { data->ClearData(); }
     data->set_serial_number( ringbuffer_serial_number_++ );
+    start_trace( data );
+    if (deadline_monitor_) { deadline_monitor_->Claimed(); }
     return data;
 }
 
@@ -58,45 +60,150 @@ inline std::vector<typename DATATYPE::DATACLASS*> SlotOut<DATATYPE>::ClaimDataN(
     
     for (auto& it : data) {
         it->set_serial_number( ringbuffer_serial_number_++ );
+        start_trace( it );
     }
     
     has_publishable_data_ = true;
+    if (deadline_monitor_) { deadline_monitor_->Claimed(); }
     
     return data;
 }
 
+template <typename DATATYPE>
+inline void SlotOut<DATATYPE>::prepare_publication() {
+    
+    for (int64_t k=ring_batch_.Start(); k<=ring_batch_.end(); ++k) {
+        typename DATATYPE::DATACLASS* data = ringbuffer_->Get( k );
+        data->PrepareForPublish();
+        if (data->traced()) { data->StampTrace( trace_hop_ ); }
+    }
+}
+
 template <typename DATATYPE>
 inline void SlotOut<DATATYPE>::PublishData() { 
     
     if (has_publishable_data_ && ringbuffer_->GetCursor()!=INT64_MAX) {
+        prepare_publication();
         ringbuffer_->Publish( ring_batch_ );
+        npublished_.fetch_add( ring_batch_.size(), std::memory_order_relaxed );
+        has_publishable_data_ = false;
+        if (deadline_monitor_) { deadline_monitor_->Published( ring_batch_.size() ); }
+        
+        for (auto & hook : publish_hooks_) { hook(); }
+        for (auto & notifier : notifiers_) { notifier->Notify(); }
+    }
+}
+
+template <typename DATATYPE>
+bool SlotOut<DATATYPE>::PublishWithoutSignal() {
+    
+    if (has_publishable_data_ && ringbuffer_->GetCursor()!=INT64_MAX) {
+        prepare_publication();
         has_publishable_data_ = false;
+        npublished_.fetch_add( ring_batch_.size(), std::memory_order_relaxed );
+        if (deadline_monitor_) { deadline_monitor_->Published( ring_batch_.size() ); }
+        return ringbuffer_->PublishWithoutSignal( ring_batch_ );
     }
+    return false;
 }
 
 template <typename DATATYPE>
-void SlotOut<DATATYPE>::CreateRingBuffer( int buffer_size, WaitStrategy wait_strategy ) {
+void SlotOut<DATATYPE>::SignalPublished() {
+    
+    ringbuffer_->SignalAllAfterFence();
+    for (auto & hook : publish_hooks_) { hook(); }
+}
+
+template <typename DATATYPE>
+void SlotOut<DATATYPE>::CreateRingBuffer( int buffer_size, WaitStrategy wait_strategy, const WaitParameters& wait_parameters,
+    ItemAllocation allocation ) {
+    
+    // co-producers get the ring buffer of their owner
+    if (owner_!=nullptr) { return; }
     
     // make sure buffer size is power of 2 and at least 2
     buffer_size_ = buffer_size<2 ? 2 : next_pow2( buffer_size );
-    datafactory_.reset( new DataFactory<DATATYPE>( streaminfo_.datatype() ) );
+    // the old ring buffer releases its items through the old data factory
+    ringbuffer_.reset();
+    datafactory_.reset( new DataFactory<DATATYPE>( streaminfo_.datatype(), allocation, numa_node_ ) );
     try {
-        ringbuffer_.reset( new RingBuffer<typename DATATYPE::DATACLASS>( datafactory_.get() , buffer_size_, ClaimStrategy::kSingleThreadedStrategy, wait_strategy ) );
+        ringbuffer_.reset( new RingBuffer<typename DATATYPE::DATACLASS>( datafactory_.get() , buffer_size_,
+            co_producers_.empty() ? ClaimStrategy::kSingleThreadedStrategy : ClaimStrategy::kMultiThreadedStrategy,
+            wait_strategy, wait_parameters ) );
     } catch (std::runtime_error & e) {
         throw;
     }
     barrier_.reset( ringbuffer_->NewBarrier( std::vector<RingSequence*>(0) ) );
     ringbuffer_->set_gating_sequences( gating_sequences() );
+    
+    ring_data_ = ringbuffer_->Get( 0 );
+    ring_stride_ = sizeof(typename DATATYPE::DATACLASS);
+    
+    for (auto & producer : co_producers_) {
+        auto slot = dynamic_cast<SlotOut<DATATYPE>*>( producer );
+        if (slot==nullptr) {
+            throw std::runtime_error( "Producers that share a ring buffer should have the same data type." );
+        }
+        if (slot->downstream_slots_!=downstream_slots_) {
+            throw std::runtime_error( "Producers that share a ring buffer should connect to the same input slots." );
+        }
+        slot->AttachRingBuffer( this );
+    }
+}
+
+template <typename DATATYPE>
+void SlotOut<DATATYPE>::AttachRingBuffer( SlotOut<DATATYPE>* owner ) {
+    
+    buffer_size_ = owner->buffer_size_;
+    datafactory_ = owner->datafactory_;
+    ringbuffer_ = owner->ringbuffer_;
+    barrier_.reset( ringbuffer_->NewBarrier( std::vector<RingSequence*>(0) ) );
+    
+    ring_data_ = owner->ring_data_;
+    ring_stride_ = owner->ring_stride_;
+}
+
+template <typename DATATYPE>
+std::size_t SlotOut<DATATYPE>::Prefault() {
+    
+    if (ringbuffer_==nullptr) { return 0; }
+    
+    // an arena holds both the items and their payloads
+    const Arena* arena = datafactory_->arena();
+    if (arena!=nullptr) {
+        return prefault_memory( arena->base(), std::min( arena->used(), arena->capacity() ) );
+    }
+    return prefault_memory( ring_data_, buffer_size_*ring_stride_ );
 }
 
 template <typename DATATYPE>
 void SlotOut<DATATYPE>::Unlock() {
     
-    if (connected()) {
-        ringbuffer_->ForcePublish( INT64_MAX );    
+    // a shared ring buffer is closed by the last producer
+    if (connected() && ReleaseProducer()) {
+        ringbuffer_->ForcePublish( INT64_MAX );
+        for (auto & notifier : notifiers_) { notifier->Notify(); }
     }
 }
 
+template <typename DATATYPE>
+void SlotOut<DATATYPE>::Reclose() {
+    
+    // shared ring buffers publish with a compare-and-set and stay closed
+    if (connected() && !shared() && unlocked_.load() && ringbuffer_->GetCursor()!=INT64_MAX) {
+        ringbuffer_->ForcePublish( INT64_MAX );
+        for (auto & notifier : notifiers_) { notifier->Notify(); }
+    }
+}
+
+template <typename DATATYPE>
+void SlotOut<DATATYPE>::UpdateGatingSequences() {
+    
+    // co-producers use the ring buffer of their owner
+    if (owner_!=nullptr || !ringbuffer_) { return; }
+    ringbuffer_->set_gating_sequences( gating_sequences() );
+}
+
 template <typename DATATYPE>
 inline RingBatch* SlotOut<DATATYPE>::next_batch( uint64_t n ) { 
     
@@ -148,7 +255,8 @@ template <typename DATATYPE>
 void PortOut<DATATYPE>::CreateRingBuffers() {
     
     for (auto& slot_it : slots_) {
-        slot_it->CreateRingBuffer(policy().buffer_size(), policy().wait_strategy());
+        slot_it->CreateRingBuffer(policy().buffer_size(), policy().wait_strategy(), policy().wait_parameters(),
+            policy().item_allocation());
     }
 }
 
@@ -203,17 +311,20 @@ bool SlotIn<DATATYPE>::RetrieveData( typename DATATYPE::DATACLASS* & data ) {
     
     try {
         if (time_out_ < 0) {
-            int64_t available_sequence = upstream_->WaitFor( requested_sequence );
+            int64_t available_sequence = timed_wait( requested_sequence );
             if (available_sequence==INT64_MAX) {
                 status_.alive = false;
             } else {
+                requested_sequence = skip_overrun( requested_sequence, available_sequence, 1 );
                 data = (typename DATATYPE::DATACLASS*) upstream_->DataAt( requested_sequence );
                 ++nretrieved_;
                 status_.read = 1;
                 status_.backlog = available_sequence - requested_sequence;
+                record_retrieval( requested_sequence, available_sequence, data );
+                if (fold_traces_) { record_trace( data ); }
             }
         } else {
-            int64_t available_sequence = upstream_->WaitFor( requested_sequence, time_out_ );
+            int64_t available_sequence = timed_wait( requested_sequence, time_out_ );
             
             if (available_sequence < requested_sequence) {
                 // timed out
@@ -222,10 +333,13 @@ bool SlotIn<DATATYPE>::RetrieveData( typename DATATYPE::DATACLASS* & data ) {
                 status_.alive = false;
             } else {
                 
+                requested_sequence = skip_overrun( requested_sequence, available_sequence, 1 );
                 data = (typename DATATYPE::DATACLASS*) upstream_->DataAt( requested_sequence );
                 ++nretrieved_;
                 status_.read = 1;
                 status_.backlog = available_sequence - requested_sequence;
+                record_retrieval( requested_sequence, available_sequence, data );
+                if (fold_traces_) { record_trace( data ); }
                 
                 if (cache_enabled_) {
                     if (ncached_==0) {--nretrieved_;}
@@ -247,7 +361,14 @@ bool SlotIn<DATATYPE>::RetrieveData( typename DATATYPE::DATACLASS* & data ) {
 }
 
 template <typename DATATYPE>
-bool SlotIn<DATATYPE>::RetrieveDataN( uint64_t n, std::vector<typename DATATYPE::DATACLASS*> & data ) {
+void SlotIn<DATATYPE>::assign_view( DataView<typename DATATYPE::DATACLASS> & data, int64_t first, int64_t last ) {
+    
+    data.assign( static_cast<typename DATATYPE::DATACLASS*>( upstream_->ring_data() ),
+        upstream_->ring_stride(), upstream_->buffer_size(), first, last - first + 1 );
+}
+
+template <typename DATATYPE>
+bool SlotIn<DATATYPE>::RetrieveDataN( uint64_t n, DataView<typename DATATYPE::DATACLASS> & data ) {
     
     // will only cache last value, but does not return cached values when timed out if n>1
     
@@ -264,32 +385,36 @@ bool SlotIn<DATATYPE>::RetrieveDataN( uint64_t n, std::vector<typename DATATYPE:
     
     try {
         if (time_out_ < 0) {
-            int64_t available_sequence = upstream_->WaitFor( requested_sequence );
+            int64_t available_sequence = timed_wait( requested_sequence );
             if (available_sequence==INT64_MAX) {
                 status_.alive = false;
             } else {
-                for (int64_t k=current_sequence+1; k<=requested_sequence; k++) {
-                    data.push_back( (typename DATATYPE::DATACLASS*) upstream_->DataAt( k ) );
-                    ++nretrieved_;
-                    ++status_.read;
-                }
+                current_sequence = skip_overrun( current_sequence+1, available_sequence, n ) - 1;
+                requested_sequence = current_sequence + n;
+                assign_view( data, current_sequence+1, requested_sequence );
+                nretrieved_ += n;
+                status_.read = n;
+                record_retrieval( current_sequence+1, available_sequence, data.front() );
+                if (fold_traces_) { for (auto item : data) { record_trace( item ); } }
                 status_.backlog = available_sequence - requested_sequence;
             }
         } else {
-            int64_t available_sequence = upstream_->WaitFor( requested_sequence, time_out_ );
+            int64_t available_sequence = timed_wait( requested_sequence, time_out_ );
             
             if (available_sequence < requested_sequence) {
                 // timed out
-                if (n==1 && cache_enabled_) { data.push_back( cache_ ); status_.read=1; }
+                if (n==1 && cache_enabled_) { data.assign( cache_ ); status_.read=1; }
             } else if (available_sequence==INT64_MAX) {
                 status_.alive = false;
             } else {
                 
-                for (int64_t k=current_sequence+1; k<=requested_sequence; k++) {
-                    data.push_back( (typename DATATYPE::DATACLASS*) upstream_->DataAt( k ) );
-                    ++nretrieved_;
-                    ++status_.read;
-                }
+                current_sequence = skip_overrun( current_sequence+1, available_sequence, n ) - 1;
+                requested_sequence = current_sequence + n;
+                assign_view( data, current_sequence+1, requested_sequence );
+                nretrieved_ += n;
+                status_.read = n;
+                record_retrieval( current_sequence+1, available_sequence, data.front() );
+                if (fold_traces_) { for (auto item : data) { record_trace( item ); } }
                 
                 status_.backlog = available_sequence - requested_sequence;
                 
@@ -310,7 +435,7 @@ bool SlotIn<DATATYPE>::RetrieveDataN( uint64_t n, std::vector<typename DATATYPE:
 }
 
 template <typename DATATYPE>
-bool SlotIn<DATATYPE>::RetrieveDataAll( std::vector<typename DATATYPE::DATACLASS*> & data ) {
+bool SlotIn<DATATYPE>::RetrieveDataAll( DataView<typename DATATYPE::DATACLASS> & data ) {
     
     // supports single item caching
       
@@ -327,30 +452,32 @@ bool SlotIn<DATATYPE>::RetrieveDataAll( std::vector<typename DATATYPE::DATACLASS
    
     try {
         if (time_out_ < 0) {
-            int64_t available_sequence = upstream_->WaitFor( requested_sequence );
+            int64_t available_sequence = timed_wait( requested_sequence );
             if (available_sequence==INT64_MAX) {
                 status_.alive = false;
             } else {
-                for (int64_t k=current_sequence+1; k<=available_sequence; k++) {    
-                    data.push_back( (typename DATATYPE::DATACLASS*) upstream_->DataAt( k ) );
-                    ++nretrieved_;
-                    ++status_.read;
-                }
+                current_sequence = skip_overrun( current_sequence+1, available_sequence, 1 ) - 1;
+                assign_view( data, current_sequence+1, available_sequence );
+                nretrieved_ += available_sequence - current_sequence;
+                status_.read = available_sequence - current_sequence;
+                record_retrieval( current_sequence+1, available_sequence, data.front() );
+                if (fold_traces_) { for (auto item : data) { record_trace( item ); } }
             }
         } else {
-            int64_t available_sequence = upstream_->WaitFor( requested_sequence, time_out_ );
+            int64_t available_sequence = timed_wait( requested_sequence, time_out_ );
             if (available_sequence < requested_sequence) {
                 // timed out
-                if (cache_enabled_) { data.push_back( cache_ ); status_.read=1; }
+                if (cache_enabled_) { data.assign( cache_ ); status_.read=1; }
             } else if (available_sequence==INT64_MAX) {
                 status_.alive = false;
             } else {
                 
-                for (int64_t k=current_sequence+1; k<=available_sequence; k++) {
-                    data.push_back( (typename DATATYPE::DATACLASS*) upstream_->DataAt( k ) );
-                    ++nretrieved_;
-                    ++status_.read;
-                }
+                current_sequence = skip_overrun( current_sequence+1, available_sequence, 1 ) - 1;
+                assign_view( data, current_sequence+1, available_sequence );
+                nretrieved_ += available_sequence - current_sequence;
+                status_.read = available_sequence - current_sequence;
+                record_retrieval( current_sequence+1, available_sequence, data.front() );
+                if (fold_traces_) { for (auto item : data) { record_trace( item ); } }
             
                 if (cache_enabled_) {
                     if (ncached_==0) {--nretrieved_;}
@@ -370,6 +497,24 @@ bool SlotIn<DATATYPE>::RetrieveDataAll( std::vector<typename DATATYPE::DATACLASS
     
 }
 
+template <typename DATATYPE>
+bool SlotIn<DATATYPE>::RetrieveDataN( uint64_t n, std::vector<typename DATATYPE::DATACLASS*> & data ) {
+    
+    DataView<typename DATATYPE::DATACLASS> view;
+    bool alive = RetrieveDataN( n, view );
+    data.assign( view.begin(), view.end() );
+    return alive;
+}
+
+template <typename DATATYPE>
+bool SlotIn<DATATYPE>::RetrieveDataAll( std::vector<typename DATATYPE::DATACLASS*> & data ) {
+    
+    DataView<typename DATATYPE::DATACLASS> view;
+    bool alive = RetrieveDataAll( view );
+    data.assign( view.begin(), view.end() );
+    return alive;
+}
+
 template <typename DATATYPE>
 void SlotIn<DATATYPE>::Unlock() {
     
@@ -389,6 +534,10 @@ void PortIn<DATATYPE>::Connect( int slot, StreamOutConnector* upstream ) {
     }
     
     slots_.at(slot)->Connect( upstream );
+    
+    if (wait_any_) {
+        upstream->slot()->AddNotifier( &notifier_ );
+    }
 }
 
 template <typename DATATYPE>
@@ -400,6 +549,11 @@ int PortIn<DATATYPE>::ReserveSlot( int slot ) {
         if ( !slots_[nconnected]->connected() ) { break; }
     }
     
+    // an input slot fed by a multi-producer slot accepts more producers
+    if (slot>=0 && slot<nconnected && slots_[slot]->upstream_policy().multi_producer()) {
+        return slot;
+    }
+    
     int reserved_slot = IdentifyNextSlot( slot, nconnected, false, policy());
     
     if (reserved_slot<0) { throw std::runtime_error("Cannot reserve slot."); }
@@ -420,7 +574,7 @@ template <typename DATATYPE>
 void PortIn<DATATYPE>::NewSlot( int n ) {
     
     for (int k=0; k<n; k++) {
-        slots_.push_back( std::move( std::unique_ptr<SlotIn<DATATYPE>>( new SlotIn<DATATYPE>(datatype_, policy().time_out(), policy().cache_enabled() ) ) ) );
+        slots_.push_back( std::move( std::unique_ptr<SlotIn<DATATYPE>>( new SlotIn<DATATYPE>(datatype_, policy().time_out(), policy().cache_enabled(), policy().lossy() ) ) ) );
     }
 }
 
@@ -430,4 +584,7 @@ void PortIn<DATATYPE>::UnlockSlots() {
     for (auto& slot_it : slots_) {
         slot_it->Unlock();
     }
+    
+    // wake up a consumer in WaitAny
+    notifier_.Notify();
 }
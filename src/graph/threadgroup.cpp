@@ -0,0 +1,181 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#include "threadgroup.hpp"
+#include "processorengine.hpp"
+#include "iprocessor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include "g3log/src/g2log.hpp"
+
+ThreadGroup::~ThreadGroup() {
+    
+    Stop();
+    thread_.Shutdown();
+}
+
+void ThreadGroup::AddProcessor( ProcessorEngine* engine ) {
+    
+    if (!engine->processor()->steppable()) {
+        throw InvalidProcessorError( "Processor does not support step-wise processing and cannot be part of thread group \"" + name_ + "\".", engine->name() );
+    }
+    
+    engines_.push_back( engine );
+    
+    if (engine->thread_priority() > thread_priority_) {
+        thread_priority_ = engine->thread_priority();
+    }
+    
+    if (thread_core_==CORE_NOT_PINNED) {
+        thread_core_ = engine->thread_core();
+    } else if (engine->thread_core()!=CORE_NOT_PINNED && engine->thread_core()!=thread_core_) {
+        LOG(WARNING) << "Thread group " << name_ << " is pinned to core " << thread_core_
+            << ", ignoring requested core " << engine->thread_core() << " for processor " << engine->name();
+    }
+}
+
+bool ThreadGroup::contains( const ProcessorEngine* engine ) const {
+    
+    return std::find( engines_.begin(), engines_.end(), engine )!=engines_.end();
+}
+
+void ThreadGroup::ThreadEntry( RunContext& runcontext ) {
+    
+    LOG(DEBUG) << "Entering thread for processor group " << name_;
+    
+    std::vector<std::unique_ptr<ProcessingContext>> contexts;
+    
+    if (runcontext.realtime_profile!=nullptr) {
+        runcontext.realtime_profile->PrepareThread( "threadgroup:" + name_, thread_priority_>=PRIORITY_MIN );
+    }
+    
+    for (auto & engine : engines_) {
+        contexts.emplace_back( new ProcessingContext( runcontext, engine->name(), engine->has_test_flag() ? engine->test_flag() : runcontext.test() ) );
+        engine->EnterProcessing( *contexts.back() );
+    }
+    
+    // wait for the go signal
+    {
+        std::unique_lock<std::mutex> lock(runcontext.mutex);
+        while (!runcontext.go_signal) { runcontext.go_condition.wait(lock); }
+    }
+    
+    std::vector<bool> done( engines_.size(), false );
+    std::size_t ndone = 0;
+    unsigned int idle_rounds = 0;
+    
+    std::size_t nsources = std::count_if( engines_.begin(), engines_.end(),
+        []( ProcessorEngine* engine ) { return engine->processor()->issource(); } );
+    std::size_t nsources_done = 0;
+    
+    accounting_.Begin();
+    
+    while (ndone < engines_.size()) {
+        
+        bool busy = false;
+        
+        for (std::size_t k=0; k<engines_.size(); ++k) {
+            
+            if (done[k]) { continue; }
+            
+            IProcessor* processor = engines_[k]->processor();
+            StepResult result = StepResult::IDLE;
+            
+            if (contexts[k]->terminated()) {
+                result = StepResult::DONE;
+            } else if (processor->ReadyForStep()) {
+                try {
+                    result = processor->ProcessStep( *contexts[k] );
+                } catch (std::exception& e) {
+                    contexts[k]->TerminateWithError( "Process", e.what() );
+                    result = StepResult::DONE;
+                }
+            }
+            
+            if (result==StepResult::DONE) {
+                engines_[k]->ExitProcessing( *contexts[k] );
+                done[k] = true;
+                ++ndone;
+                if (processor->issource()) { ++nsources_done; }
+            } else if (result==StepResult::BUSY) {
+                busy = true;
+            }
+        }
+        
+        if (busy) {
+            idle_rounds = 0;
+        } else if (offline_) {
+            // no data left in flight once the sources are done and a full round was idle
+            if (finish_when_idle_ && nsources>0 && nsources_done==nsources) {
+                LOG(INFO) << "All data has been processed offline.";
+                for (std::size_t k=0; k<engines_.size(); ++k) {
+                    if (done[k]) { continue; }
+                    engines_[k]->ExitProcessing( *contexts[k] );
+                    done[k] = true;
+                    ++ndone;
+                }
+            } else {
+                std::this_thread::yield();
+            }
+        } else if (idle_rounds < IDLE_YIELD_ROUNDS) {
+            ++idle_rounds;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for( std::chrono::microseconds( IDLE_SLEEP_MICROS ) );
+        }
+    }
+    
+    accounting_.End();
+    
+    LOG(INFO) << "Processor group " << name_ << ". " << accounting_.current().string();
+    
+    LOG(DEBUG) << "Exiting thread for processor group " << name_;
+}
+
+YAML::Node ThreadGroup::ExportUsage() const {
+    
+    YAML::Node node = accounting_.current().ExportYAML();
+    node["running"] = accounting_.active();
+    for (auto & engine : engines_) {
+        node["processors"].push_back( engine->name() );
+    }
+    return node;
+}
+
+void ThreadGroup::Start( RunContext& runcontext ) {
+    
+    Stop();
+    
+    // the thread is kept between runs of the graph
+    RunContext* context = &runcontext;
+    thread_.Run( [this, context]() { ThreadEntry( *context ); } );
+    
+    thread_.ApplyScheduling( thread_priority_, thread_core_, "processor group " + name_ );
+}
+
+void ThreadGroup::Stop() {
+    
+    if (thread_.started()) {
+        thread_.Wait();
+        LOG(DEBUG) << "processor group " << name_ << ": run finished";
+    }
+}
@@ -0,0 +1,100 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+#ifndef THREADGROUP_H
+#define THREADGROUP_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include "threadutilities.hpp"
+#include "runinfo.hpp"
+
+// forward declaration
+class ProcessorEngine;
+
+/* ThreadGroup: runs multiple processors cooperatively on a single thread
+ * 
+ * Processors are assigned to a group with the threadgroup key in the
+ * advanced section of their configuration. Rather than calling the blocking
+ * Process method, the group thread repeatedly visits all processors and calls
+ * ProcessStep for those that are ready (i.e. that have data available on
+ * their inputs and capacity on their outputs). When none of the processors
+ * could make progress, the thread backs off by first yielding and then
+ * sleeping for short periods.
+ * 
+ * The thread priority of the group is the highest priority of its members.
+ * The thread is pinned to the core of the first member that requests one.
+ * 
+ * In offline mode (graph start --offline) the processors are visited in the
+ * order in which they were added, and the thread does not back off when
+ * idle. If the group holds all processors of the graph, it finishes processing
+ * as soon as all sources are done and no processor can make progress.
+ * Processors that are not steppable (see IProcessor::steppable) keep their
+ * own thread in offline mode; the graph then is neither single-threaded nor
+ * deterministic and needs to be stopped explicitly.
+ */
+class ThreadGroup final {
+public:
+    ThreadGroup( std::string name ) : name_(name), thread_priority_(PRIORITY_NONE), thread_core_(CORE_NOT_PINNED) {}
+    ~ThreadGroup();
+    
+    const std::string name() const { return name_; }
+    
+    void AddProcessor( ProcessorEngine* engine );
+    const std::vector<ProcessorEngine*>& processors() const { return engines_; }
+    bool contains( const ProcessorEngine* engine ) const;
+    
+    void set_offline( bool finish_when_idle ) { offline_ = true; finish_when_idle_ = finish_when_idle; }
+    
+    void Start( RunContext& runcontext );
+    void Stop();
+    
+    // CPU time and context switches of the group thread in the current or last run
+    YAML::Node ExportUsage() const;
+    
+    ThreadPriority thread_priority() const { return thread_priority_; }
+    ThreadCore thread_core() const { return thread_core_; }
+    void assign_thread_core( ThreadCore core ) { thread_core_ = core; }
+
+protected:
+    void ThreadEntry( RunContext& runcontext );
+    
+protected:
+    std::string name_;
+    std::vector<ProcessorEngine*> engines_;
+    PersistentThread thread_;
+    ThreadAccounting accounting_;
+    
+    ThreadPriority thread_priority_;
+    ThreadCore thread_core_;
+    
+    bool offline_ = false;
+    bool finish_when_idle_ = false;
+    
+public:
+    // number of idle rounds in which the thread yields, before sleeping
+    const unsigned int IDLE_YIELD_ROUNDS = 1000;
+    // sleep time when idle, in microseconds
+    const unsigned int IDLE_SLEEP_MICROS = 50;
+};
+
+#endif // threadgroup.hpp
@@ -18,9 +18,18 @@
 // ---------------------------------------------------------------------
 
 #include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
 
 #include "threadutilities.hpp"
 
+#include "g3log/src/g2log.hpp"
+
 bool set_realtime_priority( pthread_t thread, ThreadPriority priority ) {
     
     if (priority<PRIORITY_MIN) {
@@ -76,3 +85,246 @@ bool set_thread_core( pthread_t thread, ThreadCore core ) {
     return true;
     
 }
+
+PersistentThread::~PersistentThread() {
+    
+    Shutdown();
+}
+
+bool PersistentThread::Run( std::function<void()> job ) {
+    
+    Wait();
+    
+    {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        job_ = std::move( job );
+        busy_ = true;
+    }
+    
+    if (thread_.joinable()) {
+        condition_.notify_all();
+        return false;
+    }
+    
+    quit_ = false;
+    scheduled_ = false;
+    thread_ = std::thread( &PersistentThread::Loop, this );
+    has_affinity_ = pthread_getaffinity_np( thread_.native_handle(), sizeof(cpu_set_t), &affinity_ )==0;
+    return true;
+}
+
+void PersistentThread::Wait() {
+    
+    std::unique_lock<std::mutex> lock( mutex_ );
+    while (busy_) { condition_.wait( lock ); }
+}
+
+void PersistentThread::Shutdown() {
+    
+    if (!thread_.joinable()) { return; }
+    
+    {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        while (busy_) { condition_.wait( lock ); }
+        quit_ = true;
+    }
+    condition_.notify_all();
+    
+    thread_.join();
+}
+
+void PersistentThread::Loop() {
+    
+    std::unique_lock<std::mutex> lock( mutex_ );
+    
+    while (true) {
+        while (!busy_ && !quit_) { condition_.wait( lock ); }
+        
+        if (!busy_) { return; }
+        
+        auto job = std::move( job_ );
+        lock.unlock();
+        job();
+        lock.lock();
+        
+        busy_ = false;
+        condition_.notify_all();
+    }
+}
+
+void PersistentThread::ApplyScheduling( ThreadPriority priority, ThreadCore core, const std::string& description ) {
+    
+    if (!thread_.joinable()) { return; }
+    
+    if (!scheduled_ || priority!=priority_) {
+        if (scheduled_ && priority_>=PRIORITY_MIN && priority<PRIORITY_MIN) {
+            // back to normal scheduling
+            struct sched_param params;
+            params.sched_priority = 0;
+            pthread_setschedparam( thread_.native_handle(), SCHED_OTHER, &params );
+        }
+        
+        if (!set_realtime_priority( thread_.native_handle(), priority )) {
+            LOG(WARNING) << "Unable to set thread priority for " << description;
+        } else if (priority>=PRIORITY_MIN) {
+            LOG(INFO) << "Successfully set thread priority for " << description << " to " << priority << "%.";
+        }
+        priority_ = priority;
+    }
+    
+    if (!scheduled_ || core!=core_) {
+        // undo pinning: the thread may run on the same cores as a new thread
+        if (scheduled_ && core_>=0 && core<0 && has_affinity_) {
+            pthread_setaffinity_np( thread_.native_handle(), sizeof(cpu_set_t), &affinity_ );
+        }
+        
+        if (!set_thread_core( thread_.native_handle(), core )) {
+            LOG(WARNING) << "Unable to pin thread for " << description << " to core " << core;
+        } else if (core>=0) {
+            LOG(INFO) << "Successfully pinned thread for " << description << " to core " << core << ".";
+        }
+        core_ = core;
+    }
+    
+    scheduled_ = true;
+}
+
+ThreadUsage ThreadUsage::operator-( const ThreadUsage& other ) const {
+    
+    ThreadUsage usage;
+    usage.cpu_ns = cpu_ns - other.cpu_ns;
+    usage.voluntary_switches = voluntary_switches - other.voluntary_switches;
+    usage.involuntary_switches = involuntary_switches - other.involuntary_switches;
+    return usage;
+}
+
+std::string ThreadUsage::string( uint64_t items ) const {
+    
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << "CPU time " << cpu_ns / 1e6 << " ms";
+    if (items>0) {
+        out << " (" << std::setprecision(3) << cpu_ns / 1e3 / items << " us/item over " << items << " items)";
+    }
+    out << ", " << voluntary_switches << " voluntary and " << involuntary_switches << " involuntary context switches.";
+    return out.str();
+}
+
+YAML::Node ThreadUsage::ExportYAML( uint64_t items ) const {
+    
+    YAML::Node node;
+    node["cpu_ms"] = cpu_ns / 1e6;
+    node["voluntary_switches"] = voluntary_switches;
+    node["involuntary_switches"] = involuntary_switches;
+    if (items>0) {
+        node["items"] = items;
+        node["cpu_us_per_item"] = cpu_ns / 1e3 / items;
+    }
+    return node;
+}
+
+uint64_t clock_ns( clockid_t clock ) {
+    
+    struct timespec ts;
+    if (clock_gettime( clock, &ts )!=0) { return 0; }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+// usage of the calling thread
+ThreadUsage self_usage() {
+    
+    ThreadUsage usage;
+    usage.cpu_ns = clock_ns( CLOCK_THREAD_CPUTIME_ID );
+    
+    struct rusage ru;
+    if (getrusage( RUSAGE_THREAD, &ru )==0) {
+        usage.voluntary_switches = ru.ru_nvcsw;
+        usage.involuntary_switches = ru.ru_nivcsw;
+    }
+    
+    return usage;
+}
+
+void ThreadAccounting::Begin() {
+    
+    std::lock_guard<std::mutex> lock( mutex_ );
+    
+    tid_ = syscall( SYS_gettid );
+    if (pthread_getcpuclockid( pthread_self(), &clock_ )!=0) {
+        clock_ = CLOCK_THREAD_CPUTIME_ID;
+    }
+    start_ = self_usage();
+    active_ = true;
+}
+
+void ThreadAccounting::End() {
+    
+    std::lock_guard<std::mutex> lock( mutex_ );
+    
+    last_run_ = self_usage() - start_;
+    active_ = false;
+}
+
+bool ThreadAccounting::active() const {
+    
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return active_;
+}
+
+ThreadUsage ThreadAccounting::current() const {
+    
+    std::lock_guard<std::mutex> lock( mutex_ );
+    
+    if (!active_) { return last_run_; }
+    
+    ThreadUsage usage;
+    usage.cpu_ns = clock_ns( clock_ );
+    
+    // rusage is only available for the calling thread
+    std::ifstream status( "/proc/self/task/" + std::to_string( tid_ ) + "/status" );
+    std::string key;
+    while (status >> key) {
+        if (key=="voluntary_ctxt_switches:") {
+            status >> usage.voluntary_switches;
+        } else if (key=="nonvoluntary_ctxt_switches:") {
+            status >> usage.involuntary_switches;
+        }
+    }
+    
+    return usage - start_;
+}
+
+std::vector<std::exception_ptr> run_concurrently( const std::vector<std::function<void()>>& tasks,
+    unsigned int nworkers ) {
+    
+    std::vector<std::exception_ptr> errors( tasks.size() );
+    std::atomic<std::size_t> next(0);
+    
+    auto worker = [&tasks, &errors, &next]() {
+        std::size_t k;
+        while ((k = next++) < tasks.size()) {
+            try {
+                tasks[k]();
+            } catch (...) {
+                errors[k] = std::current_exception();
+            }
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for (std::size_t k=1; k<nworkers && k<tasks.size(); ++k) {
+        try {
+            threads.emplace_back( worker );
+        } catch (std::system_error&) {
+            // continue with the workers that could be started
+            break;
+        }
+    }
+    
+    worker();
+    
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    
+    return errors;
+}
@@ -21,6 +21,18 @@
 #define THREADUTILITIES_H
 
 #include <thread>
+#include <functional>
+#include <exception>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <sched.h>
+#include <sys/types.h>
+
+#include "yaml-cpp/yaml.h"
 
 typedef int16_t ThreadPriority;
 
@@ -38,4 +50,91 @@ bool set_realtime_priority( pthread_t thread, ThreadPriority priority = PRIORITY
 
 bool set_thread_core( pthread_t thread, ThreadCore core );
 
+/* PersistentThread: a thread that is parked between jobs
+ * 
+ * Run hands a job (e.g. a processing run) to the thread, which is created
+ * on first use. Wait blocks until the job has finished, after which the
+ * thread waits for the next job. Priority and core are only applied again
+ * when they differ from the ones applied before. The thread is terminated
+ * by Shutdown or when the object is destroyed.
+ */
+class PersistentThread final {
+public:
+    PersistentThread() = default;
+    ~PersistentThread();
+    
+    PersistentThread( const PersistentThread& ) = delete;
+    PersistentThread& operator=( const PersistentThread& ) = delete;
+    
+    // returns true if a new thread was created for the job
+    bool Run( std::function<void()> job );
+    void Wait();
+    void Shutdown();
+    
+    bool started() const { return thread_.joinable(); }
+    
+    void ApplyScheduling( ThreadPriority priority, ThreadCore core, const std::string& description );
+    
+private:
+    void Loop();
+    
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::function<void()> job_;
+    bool busy_ = false;
+    bool quit_ = false;
+    
+    bool scheduled_ = false;
+    ThreadPriority priority_ = PRIORITY_NONE;
+    ThreadCore core_ = CORE_NOT_PINNED;
+    // affinity of the thread when it was created (e.g. restricted by
+    // taskset, isolcpus or a cgroup), restored when it is unpinned
+    cpu_set_t affinity_;
+    bool has_affinity_ = false;
+};
+
+// CPU time and context switches of a thread
+struct ThreadUsage {
+    uint64_t cpu_ns = 0;
+    int64_t voluntary_switches = 0;
+    int64_t involuntary_switches = 0;
+    
+    ThreadUsage operator-( const ThreadUsage& other ) const;
+    
+    // summary, with the CPU cost per item if items>0
+    std::string string( uint64_t items = 0 ) const;
+    YAML::Node ExportYAML( uint64_t items = 0 ) const;
+};
+
+/* ThreadAccounting: resource usage of a processing thread during a run
+ * 
+ * Begin and End are called by the thread itself around processing; they
+ * sample CLOCK_THREAD_CPUTIME_ID and getrusage(RUSAGE_THREAD). While the run
+ * is in progress, current() can be called from any thread: it reads the CPU
+ * clock of the thread and its context switch counters in /proc.
+ */
+class ThreadAccounting final {
+public:
+    void Begin();
+    void End();
+    
+    bool active() const;
+    // usage of the run in progress, or of the last run
+    ThreadUsage current() const;
+    
+private:
+    mutable std::mutex mutex_;
+    bool active_ = false;
+    clockid_t clock_;
+    pid_t tid_ = 0;
+    ThreadUsage start_;
+    ThreadUsage last_run_;
+};
+
+// run all tasks on at most nworkers threads (including the calling thread)
+// and return the exception raised by each task (or nullptr), in task order
+std::vector<std::exception_ptr> run_concurrently( const std::vector<std::function<void()>>& tasks,
+    unsigned int nworkers );
+
 #endif
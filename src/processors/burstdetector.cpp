@@ -257,6 +257,7 @@ void BurstDetector::Process(ProcessingContext& context) {
             if ( stream_events_->get() ) {
                 event_out = data_out_port_->slot(0)->ClaimData(false);
                 event_out->set_source_timestamp( data_in->source_timestamp() );
+                event_out->CloneTrace( *data_in );
                 event_out->set_hardware_timestamp( data_in->hardware_timestamp() );
                 data_out_port_->slot(0)->PublishData();
             }
@@ -71,10 +71,8 @@ void Decoder::CreatePorts( ) {
         LikelihoodDataType(),
         PortOutPolicy( SlotRange(1) ) );
     
-    std::intptr_t none = 0;
-    encoding_model_ = create_readable_shared_state(
+    encoding_model_ = create_readable_snapshot_state<EncodingModel>(
         "encoding_model",
-        none,
         Permission::WRITE,
         Permission::NONE );
 }
@@ -110,6 +108,7 @@ void Decoder::Prepare( GlobalContext& context ) {
     if ( use_offline_model_ ) {
         offline_model_ = new EncodingModel( n_features_, path_to_grid_ );
         offline_model_->from_disk( path_to_offline_model_ );
+        offline_model_->compute_lambda_x();
         LOG_IF(INFO, (offline_model_ != nullptr)) << name() <<
             ". Encoding model loaded successfully from "
             << path_to_offline_model_ << ".";
@@ -190,8 +189,7 @@ void Decoder::Process( ProcessingContext& context ) {
     double time_bin = time_bin_ms_ / 1000; // decoding uses seconds
     unsigned int s, g;
 
-//    EncodingModel* model = get_model();
-    assert( n_grid_points_ == get_model()->n_grid_elements() );
+    assert( !use_offline_model_ || n_grid_points_ == get_model()->n_grid_elements() );
     
     while ( !context.terminated() ) {
         
@@ -199,8 +197,17 @@ void Decoder::Process( ProcessingContext& context ) {
         if (!data_in_port_->slot(0)->RetrieveData( data_in )) {break;}
         n_spikes = data_in->n_detected_spikes();
         
-        // prepare Likelihood Data item with TS info
+        // prepare Likelihood Data item with TS info and hold on to the
+        // current version of the online model for the whole bin
         if ( n_spike_buffers == 0 ) {
+            if ( !use_offline_model_ ) {
+                model_snapshot_ = encoding_model_->acquire();
+                if ( !model_snapshot_ ) { // no model published yet
+                    data_in_port_->slot(0)->ReleaseData();
+                    continue;
+                }
+                assert( n_grid_points_ == get_model()->n_grid_elements() );
+            }
             data_out = data_out_port_->slot(0)->ClaimData( true );
             data_out->set_hardware_timestamp( data_in->hardware_timestamp() );
         }
@@ -217,7 +224,7 @@ void Decoder::Process( ProcessingContext& context ) {
                     assert( get_model() != nullptr );
                     mixture_evaluategrid_diagonal_multi(
                         get_model()->pax_model(),
-                        get_model()->accumulator().data(),
+                        get_accumulator(),
                         n_grid_points_,
                         data_in->amplitudes().data(),
                         n_spikes,
@@ -265,18 +272,20 @@ void Decoder::Process( ProcessingContext& context ) {
             data_out_port_->slot(0)->PublishData();
             n_spike_buffers = 0;
             
-            // update model (regulate frequency of checks for new model?)
-            //delete model; model = nullptr;
-//            model = get_model();
             LOG_IF(DEBUG, (data_out_port_->slot(0)->nitems_produced()%500 == 0))
                 << name() << ". Model has " << get_model()->n_components_pax()
                 << " components.";
+            
+            // the next bin picks up the latest published model
+            model_snapshot_.release();
         }
     }
 }
 
 void Decoder::Postprocess( ProcessingContext& context ) {
 
+    model_snapshot_.release();
+
     LOG(INFO) << name() << ". " << data_out_port_->slot(0)->nitems_produced()
         << " likelihoods computed.";
 }
@@ -294,7 +303,7 @@ void Decoder::Unprepare( GlobalContext& context ) {
     }
 }
 
-void Decoder::evaluate_test_amplitudes( EncodingModel* model,
+void Decoder::evaluate_test_amplitudes( const EncodingModel* model,
 unsigned int n_spikes ) {
 
     if ( n_used_spikes_ >= n_test_spikes_ ) {
@@ -304,7 +313,7 @@ unsigned int n_spikes ) {
 
     mixture_evaluategrid_diagonal_multi(
         model->pax_model(),
-        model->accumulator().data(),
+        get_accumulator(),
         model->n_grid_elements(),
         test_spike_amplitudes_ptr_,
         n_spikes,
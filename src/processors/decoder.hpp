@@ -31,8 +31,9 @@
  * estimates <LikelihoodData> (1 slot)
  *
  * exposed states:
- * encoding_model <intptr_t> - pointer to the data structure containing the model
- * together with some precomputations of the decoding elements
+ * encoding_model <snapshot EncodingModel> - published model together with
+ * the precomputations of the decoding elements (lambda_x is completed when a
+ * new version is published); a snapshot of the model is used for each bin
  *
  * exposed methods:
  * none
@@ -71,20 +72,32 @@ public:
     virtual void Unprepare( GlobalContext& context ) override;
 
 protected:
-    inline EncodingModel* get_model() {
-        // must return naked pointer because of casting and I don't know if the
-        // casting will work fine with a smart pointer
+    // models are only read while decoding
+    inline const EncodingModel* get_model() const {
+        
         if ( use_offline_model_ ) {
             return offline_model_;
         }
-        return reinterpret_cast<EncodingModel*> (encoding_model_->get() );
+        return model_snapshot_.get();
     }
-    void evaluate_test_amplitudes( EncodingModel* model, unsigned int n_spikes );
+    // scratch space for the mixture evaluation; a shared model is not
+    // written to, so online models use our own accumulator
+    inline double* get_accumulator() {
+        
+        if ( use_offline_model_ ) {
+            return offline_model_->accumulator().data();
+        }
+        accumulator_.resize( get_model()->accumulator().size() );
+        return accumulator_.data();
+    }
+    void evaluate_test_amplitudes( const EncodingModel* model, unsigned int n_spikes );
     
 protected:
     PortIn<SpikeDataType>* data_in_port_;
     PortOut<LikelihoodDataType>* data_out_port_;
-    ReadableState<std::intptr_t>* encoding_model_;
+    ReadableSnapshotState<EncodingModel>* encoding_model_;
+    Snapshot<EncodingModel> model_snapshot_;
+    std::vector<double> accumulator_;
     
     double time_bin_ms_; // decoding bin size
     bool strict_time_bin_check_; // if true, time_bin will be checked according to strict rules, otherwise it will be adjusted if not in compliance
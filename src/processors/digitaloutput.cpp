@@ -23,6 +23,7 @@
 #include "dio/dummydio.hpp"
 #include "dio/advantechdio.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 void DigitalOutput::Configure(const YAML::Node& node, const GlobalContext& context) {
@@ -145,6 +146,31 @@ void DigitalOutput::CreatePorts() {
         default_disable_delays_,
         Permission::READ,
         Permission::WRITE);
+    
+    expose_method( "latency", &DigitalOutput::Latency );
+}
+
+YAML::Node DigitalOutput::Latency( const YAML::Node & node ) {
+    
+    // records are complete up to nlatencies_, also while processing
+    std::size_t n = nlatencies_.load( std::memory_order_acquire );
+    std::vector<int64_t> latency( latency_ns_.begin(), latency_ns_.begin() + n );
+    std::sort( latency.begin(), latency.end() );
+    
+    YAML::Node result;
+    result["n"] = n;
+    if (n==0) { return result; }
+    
+    auto percentile = [&latency]( double p ) {
+        return latency[ std::min( latency.size()-1, (std::size_t)( p/100.0 * latency.size() ) ) ];
+    };
+    result["p50"] = percentile( 50 );
+    result["p90"] = percentile( 90 );
+    result["p99"] = percentile( 99 );
+    result["p99.9"] = percentile( 99.9 );
+    result["max"] = latency.back();
+    
+    return result;
 }
 
 void DigitalOutput::Preprocess( ProcessingContext& context ) {
@@ -157,6 +183,9 @@ void DigitalOutput::Preprocess( ProcessingContext& context ) {
     previous_TS_nostim_.assign( data_in_port_->number_of_slots(),
         std::numeric_limits<uint64_t>::min() );
     delta_TS_ms_.resize( data_in_port_->number_of_slots() );
+    
+    latency_ns_.resize( MAX_LATENCY_RECORDS );
+    nlatencies_.store( 0, std::memory_order_release );
      
     if ( context.test() and roundtrip_latency_test_ ) {
         prepare_latency_test( context );
@@ -193,8 +222,16 @@ void DigitalOutput::Process( ProcessingContext& context ) {
                             test_source_timestamps_[nprotocol_executions_] = Clock::now();
                         }
 
+                        auto execution_time = Clock::now();
                         protocols_[ data_in->event() ]->execute( *device_, disable_delays_->get() );
                         ++ nprotocol_executions_;
+                        
+                        std::size_t n = nlatencies_.load( std::memory_order_relaxed );
+                        if (n < latency_ns_.size() && data_in->source_timestamp()!=TimePoint()) {
+                            latency_ns_[n] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                execution_time - data_in->source_timestamp() ).count();
+                            nlatencies_.store( n+1, std::memory_order_release );
+                        }
                         LOG_IF(UPDATE, print_protocol_execution_updates_) << name()
                             << ". Protocol executed for " << data_in->event() << " event.";
                     } catch ( DigitalDeviceError & e ) {
@@ -30,7 +30,9 @@
  * enabled <bool> - enable/disable digital output
  *
  * exposed methods:
- * none
+ * latency - returns the distribution (n, p50, p90, p99, p99.9 and max,
+ *   in ns) of the time between the source timestamp of an event and the
+ *   execution of its protocol, for the current or last run
  *
  * options:
  * enabled <bool> - default for enabled state
@@ -69,6 +71,8 @@
 #ifndef DIGITALOUTPUT_HPP
 #define DIGITALOUTPUT_HPP
 
+#include <atomic>
+
 #include "../graph/iprocessor.hpp"
 #include "../data/eventdata.hpp"
 #include "dio/dio.hpp"
@@ -90,6 +94,8 @@ public:
 protected:
     bool to_lock_out( const uint64_t current_timestamp, SlotType s );
     
+    YAML::Node Latency( const YAML::Node & node );
+    
 protected:
     PortIn<EventDataType>* data_in_port_;
     
@@ -118,6 +124,10 @@ protected:
     std::vector<uint64_t> previous_TS_nostim_;
     std::vector<decltype(default_lockout_period_ms_)> delta_TS_ms_;
     
+    // source-to-execution latencies (ns), allocated before processing starts
+    std::vector<int64_t> latency_ns_;
+    std::atomic<std::size_t> nlatencies_{0};
+    
 public:
     const decltype(default_enabled_) DEFAULT_ENABLED = true;
     const decltype(default_lockout_period_ms_) DEFAULT_LOCKOUT_PERIOD_MS = 300;
@@ -128,6 +138,7 @@ public:
     const int DEFAULT_ADVANTECH_PORT = -1;
     const std::uint64_t DEFAULT_ADVANTECH_DELAY = 10;
     const decltype(default_disable_delays_) DEFAULT_DISABLE_DELAYS = false;
+    const std::size_t MAX_LATENCY_RECORDS = 1000000;
     
 protected:
     const std::string STIM_EVENT_S = "stim_";
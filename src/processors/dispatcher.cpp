@@ -47,7 +47,7 @@ void Dispatcher::CreatePorts() {
         data_ports_[it.first] = create_output_port(
             it.first,
             MultiChannelDataType<double>( ChannelRange(it.second.size()) ),
-            PortOutPolicy( SlotRange(1), 2000, WaitStrategy::kBlockingStrategy ) );
+            PortOutPolicy( SlotRange(1), 2000, WaitStrategy::kFutexBlockingStrategy ) );
     }
 }
 
@@ -81,8 +81,13 @@ void Dispatcher::Prepare( GlobalContext& context ) {
 }
 
 void Dispatcher::Preprocess( ProcessingContext& context ) {
-
     
+    // publish all output ports together, so that downstream processors are
+    // only woken up once all buckets are available
+    publish_group_ = PublishGroup();
+    for (auto & it : data_ports_ ) {
+        publish_group_.Add( it.second );
+    }
 }
 
 void Dispatcher::Process( ProcessingContext& context ) {
@@ -105,6 +110,7 @@ void Dispatcher::Process( ProcessingContext& context ) {
             data_out_vector[port_index]->set_hardware_timestamp(
                 data_in->hardware_timestamp() );
             data_out_vector[port_index]->set_source_timestamp();
+            data_out_vector[port_index]->CloneTrace( *data_in );
             port_index++;
         }
         
@@ -113,7 +119,7 @@ void Dispatcher::Process( ProcessingContext& context ) {
         for ( auto const& it_chmap : channelmap_ ) {
             
             data_out_vector[port_index]->set_sample_timestamps(
-                data_in->sample_timestamps() );
+                static_cast<const MultiChannelData<double>*>( data_in )->sample_timestamps() );
             assert(it_chmap.second.size() > 0);
             for ( ch=0; ch<it_chmap.second.size(); ch++ ) {
                 for ( s=0; s<incoming_batch_size_; s++ ) {
@@ -125,9 +131,7 @@ void Dispatcher::Process( ProcessingContext& context ) {
         }
             
         // publish data buckets
-        for (auto & it: data_ports_ ) {
-            it.second->slot(0)->PublishData();
-        }
+        publish_group_.Publish();
         input_port_->slot(0)->ReleaseData();
         
     }//while
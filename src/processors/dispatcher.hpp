@@ -80,6 +80,7 @@ public:
 protected:
     PortIn<MultiChannelDataType<double>>* input_port_;
     std::map<std::string, PortOut<MultiChannelDataType<double>>*> data_ports_;
+    PublishGroup publish_group_;
     
     ChannelMap channelmap_;
 //    unsigned int n_samples_;
@@ -43,7 +43,7 @@ void DummySink::Process(ProcessingContext& context) {
     uint64_t packet_counter = 0;
     uint64_t retrieve_counter = 0;
     
-    std::vector<IData*> data;
+    DataView<IData> data;
     
     auto address = data_port_->slot(0)->upstream_address();
     
@@ -62,7 +62,7 @@ void DummySink::Process(ProcessingContext& context) {
             break;
         }
         
-        for (auto & it : data ) {
+        for (auto it : data ) {
             if ( it->eos() ) {
                 LOG(DEBUG) << name() << " received end of stream signal.";
                 eos = true;
@@ -230,7 +230,7 @@ std::tuple<bool, bool, std::size_t> EventFilter::is_there_target(
     PortIn<EventDataType>* input_port, EventCounter& event_counter,
     std::vector<TimePoint>& arrival_times, std::vector<uint64_t>& arrival_timestamps ) {
     
-    std::vector<EventData*> data_in;
+    DataView<EventData> data_in;
     std::size_t slot_index = std::numeric_limits<std::size_t>::max();
     bool target_received = false;
     
@@ -248,9 +248,9 @@ std::tuple<bool, bool, std::size_t> EventFilter::is_there_target(
             continue;
         }
         if ( nread>1 and not discard_warnings_ ) {
-            std::string events_list = data_in[1]->event();
-            for ( auto el=data_in.begin()+1; el!=data_in.end()-1; ++el ) {
-                events_list += ( ", " + (*el)->event() );
+            std::string events_list = data_in[0]->event();
+            for ( decltype(nread) el=1; el<nread-1; ++el ) {
+                events_list += ( ", " + data_in[el]->event() );
             }
             LOG(WARNING) << name() << ". " << nread-1 <<
                 " events on port " << input_port->name() << "( " << events_list
@@ -70,7 +70,8 @@ void EventSync::Process( ProcessingContext& context ) {
             
             data_out = data_out_port_->slot(0)->ClaimData(false);
             
-            data_out->set_source_timestamp( );
+            // the synced event is as old as the latest of the target events
+            data_out->set_source_timestamp( timestamps_.source );
             data_out->set_hardware_timestamp( timestamps_.hw );
             
             data_out->set_event( target_event_ );
@@ -23,6 +23,7 @@
 #include "g3log/src/g2log.hpp"
 #include "utilities/time.hpp"
 
+#include <algorithm>
 #include <fstream>
 
 
@@ -66,6 +67,9 @@ void FileSerializer::CreatePorts() {
         "data",
         AnyDataType(),
         PortInPolicy( SlotRange(1,256), false, time_out_us_ ) );
+    
+    // sleep on all slots at once, rather than polling them in turn
+    data_port_->enable_wait_any();
 }
 
 void FileSerializer::Preprocess(ProcessingContext& context) {
@@ -77,6 +81,7 @@ void FileSerializer::Preprocess(ProcessingContext& context) {
     packetid_.assign( data_port_->number_of_slots(), 0 );
     upstream_buffer_size_.assign( data_port_->number_of_slots(), 0 );
     nskipped_.assign(data_port_->number_of_slots(), 0 );
+    finished_.assign( data_port_->number_of_slots(), false );
     throttle_level_ = 0;
     
     // create output file streams
@@ -137,71 +142,108 @@ void FileSerializer::create_preamble( std::ostream & out, int slot ) {
 }
 
 
+void FileSerializer::serialize_data( int slot, const DataView<IData>& data ) {
+    
+    uint64_t nread = data.size();
+    uint64_t remainder;
+    
+    if (!throttle_) {
+        
+        LOG_IF(WARNING,(nread>0.5*upstream_buffer_size_[slot])) << name() <<
+            ": buffer is more than half full (stream " << slot << ")";
+        for (auto it : data) {                
+            serializer_->Serialize( *(streams_[slot]), it, slot, packetid_[slot]++ );
+        }
+        
+    } else {
+        
+        // update throttle level
+        throttle_level_ *= (1-throttle_smooth_);
+        if (nread>throttle_threshold_*upstream_buffer_size_[slot]) {
+            throttle_level_ += throttle_smooth_;
+        }
+        
+        remainder = std::floor( 1.0 / ( 0.5 - std::abs(throttle_level_ - 0.5)));
+        
+        if (throttle_level_==0 || (throttle_level_<0.5 && remainder>nread) ) {
+            // keep all
+            for (auto it : data) {                
+                serializer_->Serialize( *(streams_[slot]), it, slot, packetid_[slot]++ );
+            }
+        } else if (throttle_level_<0.5) {
+            // skip small fraction
+            for ( uint64_t n=0; n<nread; ++n) {
+                if (n%remainder==0) {packetid_[slot]++; nskipped_[slot]++; continue;}
+                serializer_->Serialize( *(streams_[slot]), data[n], slot, packetid_[slot]++ );
+            }
+        } else if (throttle_level_==1 || (throttle_level_>=0.5 && remainder>nread)) {
+            //skip all
+            packetid_[slot]+=nread;
+            nskipped_[slot]+=nread;
+        } else {
+            //keep small fraction
+            for ( uint64_t n=0; n<nread; ++n) {
+                if (n%remainder!=0) {packetid_[slot]++; nskipped_[slot]++; continue;}
+                serializer_->Serialize( *(streams_[slot]), data[n], slot, packetid_[slot]++ );
+            }
+        }
+    }
+}
+
 void FileSerializer::Process(ProcessingContext& context) {
       
-    std::vector<IData*> data;
+    DataView<IData> data;
     
     int nslots = data_port_->number_of_slots();
-
-    uint64_t remainder;
-    uint64_t nread;
     
     while (!context.terminated()) {
         
+        if (data_port_->WaitAny( time_out_us_ )<0) { continue; }
+        
         for (int k=0; k<nslots; ++k) {
             
-            if (!data_port_->slot(k)->RetrieveDataAll( data )) {break;}
+            if (!data_port_->slot(k)->DataAvailable()) { continue; }
             
-            nread = data_port_->slot(k)->status_read();
-            if (nread==0) { data_port_->slot(k)->ReleaseData(); continue; }
+            if (!data_port_->slot(k)->RetrieveDataAll( data )) {break;}
             
-            if (!throttle_) {
-                
-                LOG_IF(WARNING,(nread>0.5*upstream_buffer_size_[k])) << name() <<
-                    ": buffer is more than half full (stream " << k << ")";
-                for (auto & it : data) {                
-                    serializer_->Serialize( *(streams_[k]), it, k, packetid_[k]++ );
-                }
-                
-            } else {
-                
-                // update throttle level
-                throttle_level_ *= (1-throttle_smooth_);
-                if (nread>throttle_threshold_*upstream_buffer_size_[k]) {
-                    throttle_level_ += throttle_smooth_;
-                }
-                
-                remainder = std::floor( 1.0 / ( 0.5 - std::abs(throttle_level_ - 0.5)));
-                
-                if (throttle_level_==0 || (throttle_level_<0.5 && remainder>nread) ) {
-                    // keep all
-                    for (auto & it : data) {                
-                        serializer_->Serialize( *(streams_[k]), it, k, packetid_[k]++ );
-                    }
-                } else if (throttle_level_<0.5) {
-                    // skip small fraction
-                    for ( uint64_t n=0; n<nread; ++n) {
-                        if (n%remainder==0) {packetid_[k]++; nskipped_[k]++; continue;}
-                        serializer_->Serialize( *(streams_[k]), data[n], k, packetid_[k]++ );
-                    }
-                } else if (throttle_level_==1 || (throttle_level_>=0.5 && remainder>nread)) {
-                    //skip all
-                    packetid_[k]+=nread;
-                    nskipped_[k]+=nread;
-                } else {
-                    //keep small fraction
-                    for ( uint64_t n=0; n<nread; ++n) {
-                        if (n%remainder!=0) {packetid_[k]++; nskipped_[k]++; continue;}
-                        serializer_->Serialize( *(streams_[k]), data[n], k, packetid_[k]++ );
-                    }
-                }
-            }
+            if (data_port_->slot(k)->status_read()>0) { serialize_data( k, data ); }
             
             data_port_->slot(k)->ReleaseData();
         }
     }
 }
 
+StepResult FileSerializer::ProcessStep( ProcessingContext& context ) {
+    
+    DataView<IData> data;
+    bool busy = false;
+    
+    // retrieval does not block on a slot with available data (or whose
+    // upstream slot has finished)
+    for (int k=0; k<data_port_->number_of_slots(); ++k) {
+        
+        if (finished_[k] || !data_port_->slot(k)->DataAvailable()) { continue; }
+        
+        if (!data_port_->slot(k)->RetrieveDataAll( data )) {
+            finished_[k] = true;
+            continue;
+        }
+        
+        if (data_port_->slot(k)->status_read()>0) {
+            serialize_data( k, data );
+            busy = true;
+        }
+        
+        data_port_->slot(k)->ReleaseData();
+    }
+    
+    if (std::find( finished_.begin(), finished_.end(), false )==finished_.end()) {
+        return StepResult::DONE;
+    }
+    
+    return busy ? StepResult::BUSY : StepResult::IDLE;
+}
+
 void FileSerializer::Postprocess( ProcessingContext& context ) {
     
     streams_.clear(); // forces destruction and closing of resources
@@ -40,6 +40,7 @@
  * throttle_threshold <double> - upstream ringbuffer fill fraction (0-1)
  *   at which throttling takes effect
  * throttle_smooth <double> - smooth level of throttle level (0-1)
+ * time_out_us <int> - maximum time to sleep while waiting for data on any slot
  * 
  */
 
@@ -57,9 +58,14 @@ public:
     virtual void Preprocess(ProcessingContext& context) override;
     virtual void Process( ProcessingContext& context ) override;
     virtual void Postprocess( ProcessingContext& context ) override;
+    
+    virtual bool steppable() const override { return true; }
+    virtual StepResult ProcessStep( ProcessingContext& context ) override;
 
 protected:
     void create_preamble( std::ostream & out, int slot );
+    // serialize (part of) the retrieved data, depending on the throttle level
+    void serialize_data( int slot, const DataView<IData>& data );
     
 protected:
     PortIn<AnyDataType>* data_port_;
@@ -79,6 +85,7 @@ protected:
     
     double throttle_level_;
     std::vector<uint64_t> nskipped_;
+    std::vector<bool> finished_; // stepped processing: upstream slot has finished
     int64_t time_out_us_;
 
 public:
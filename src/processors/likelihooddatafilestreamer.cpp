@@ -139,32 +139,54 @@ void LikelihoodDataFileStreamer::Prepare( GlobalContext& context) {
         << ". Last n_spike: " << loaded_n_spikes_[n_packets_to_stream_-1];
 }
 
+void LikelihoodDataFileStreamer::Preprocess( ProcessingContext& context ) {
+    
+    packet_index_ = 0;
+    pacer_.Start( streaming_rate_ );
+}
+
+void LikelihoodDataFileStreamer::stream_packet() {
+    
+    LikelihoodData* data = data_out_port_->slot(0)->ClaimData( true );
+    
+    data->set_time_bin( time_bin_ms_ );
+    data->add_spikes( loaded_n_spikes_[packet_index_] );
+    data->set_log_likelihood( loaded_log_likelihoods_[packet_index_], grid_size_ );
+    data->set_hardware_timestamp( generated_hw_timestamps_[packet_index_] );
+    data->set_source_timestamp();
+    
+    ++ packet_index_;
+    
+    data_out_port_->slot(0)->PublishData();
+}
+
 void LikelihoodDataFileStreamer::Process(ProcessingContext& context) {
     
-    LikelihoodData* data = nullptr;
     auto delay = std::chrono::microseconds( static_cast<unsigned int>(
         1e6 / streaming_rate_ ) );  
-    decltype(n_packets_to_stream_) i = 0;
     
     while ( !context.terminated() &&
             data_out_port_->slot(0)->nitems_produced() < n_packets_to_stream_ ) {
         
-        data = data_out_port_->slot(0)->ClaimData( true );
+        stream_packet();
         
-        data->set_time_bin( time_bin_ms_ );
-        data->add_spikes( loaded_n_spikes_[i] );
-        data->set_log_likelihood( loaded_log_likelihoods_[i], grid_size_ );
-        data->set_hardware_timestamp( generated_hw_timestamps_[i] );
-        data->set_source_timestamp();
-        
-        ++ i;
-        
-        data_out_port_->slot(0)->PublishData();
-        
-        std::this_thread::sleep_for( delay );
+        // offline runs stream as fast as downstream processors allow
+        if (!context.offline()) { std::this_thread::sleep_for( delay ); }
     }   
 }
 
+StepResult LikelihoodDataFileStreamer::ProcessStep( ProcessingContext& context ) {
+    
+    if (data_out_port_->slot(0)->nitems_produced() >= n_packets_to_stream_) { return StepResult::DONE; }
+    
+    // online steps are paced at streaming_rate, offline steps stream a
+    // packet on every call
+    if (!context.offline() && !pacer_.Due()) { return StepResult::IDLE; }
+    
+    stream_packet();
+    return StepResult::BUSY;
+}
+
 void LikelihoodDataFileStreamer::Postprocess( ProcessingContext& context ) {
     
     LOG(INFO) << name()<< ". STREAMED " << data_out_port_->slot(0)->nitems_produced()
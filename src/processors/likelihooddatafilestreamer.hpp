@@ -49,7 +49,7 @@
  * sample_rate <double> - sample rate of the signal used for detecting the spikes
  * that generated the likelihood
  * streaming_rate <double> - (approximate) streaming rate of the each
- * generated LikelihoodData item 
+ * generated LikelihoodData item (ignored in offline runs)
  * initial_timestamp <uint64_t> - timestamp of the first streamed LikelihoodData packet
  */
 
@@ -60,6 +60,7 @@
 #include "../data/likelihooddata.hpp"
 #include "npyreader/npyreader.h"
 #include "neuralynx/nlx.hpp"
+#include "utilities/time.hpp"
 
 
 class LikelihoodDataFileStreamer : public IProcessor {
@@ -69,9 +70,16 @@ public:
     virtual void CreatePorts() override;
     virtual void CompleteStreamInfo() override;
     virtual void Prepare( GlobalContext& context ) override;
+    virtual void Preprocess( ProcessingContext& context ) override;
     virtual void Process( ProcessingContext& context ) override;
     virtual void Postprocess( ProcessingContext& context ) override;
     virtual void Unprepare( GlobalContext& context ) override;  
+    
+    virtual bool steppable() const override { return true; }
+    virtual StepResult ProcessStep( ProcessingContext& context ) override;
+
+protected:
+    void stream_packet();
 
 protected:
     PortOut<LikelihoodDataType>* data_out_port_;
@@ -91,6 +99,8 @@ protected:
     uint32_t grid_size_;
     std::vector<uint64_t> generated_hw_timestamps_;
     uint32_t n_packets_to_stream_;
+    uint32_t packet_index_; // next packet to stream
+    Pacer pacer_; // paces stepped packets
 
 public:
     const uint64_t DEFAULT_INITIAL_TS = 0;
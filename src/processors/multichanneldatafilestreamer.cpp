@@ -103,39 +103,59 @@ void MultichannelDataFileStreamer::Prepare( GlobalContext& context ) {
         << ". Last generated TS: " << generated_hw_timestamps_[n_samples_-1];
 }
 
+void MultichannelDataFileStreamer::Preprocess( ProcessingContext& context ) {
+    
+    sample_index_ = 0;
+    pacer_.Start( streaming_rate_ );
+}
+
+void MultichannelDataFileStreamer::stream_packet() {
+    
+    MultiChannelData<double>* data = data_port_->slot(0)->ClaimData( false );
+    decltype(batch_size_) data_sample_idx = 0; // MCD index
+    
+    data->set_source_timestamp();
+    data->set_hardware_timestamp( generated_hw_timestamps_[sample_index_] ); 
+    
+    // loop through loaded data and copy to MultiChannelData item
+    for ( auto s = sample_index_; s < sample_index_ + batch_size_; ++ s ) { 
+        for ( decltype(n_channels_) c = 0; c < n_channels_; ++c ) {
+            data->set_data_sample( data_sample_idx, c, loaded_data_[c][s] );
+        }
+        data->set_sample_timestamp(data_sample_idx, generated_hw_timestamps_[s] );
+        ++ data_sample_idx;
+    }
+    
+    data_port_->slot(0)->PublishData();
+    
+    sample_index_ += batch_size_;
+}
+
 void MultichannelDataFileStreamer::Process(ProcessingContext& context) {
     
-    MultiChannelData<double>* data = nullptr;
     auto delay = std::chrono::microseconds( static_cast<unsigned int>( 1e6 / streaming_rate_ ) );
-    decltype(batch_size_) s = 0; // will loop through all loaded data and generated hw timestamps
-    decltype(batch_size_) sample_index = 0, data_sample_idx = 0;;
-    decltype(n_channels_) c = 0;;
 
     while ( !context.terminated() && data_port_->slot(0)->nitems_produced() < n_packets_to_dispatch_ ) {
         
-        data = data_port_->slot(0)->ClaimData( false );
-        
-        data->set_source_timestamp();
-        data->set_hardware_timestamp( generated_hw_timestamps_[s] ); 
-        
-        // loop through loaded data and copy to MultiChannelData item
-        data_sample_idx = 0; // MCD index
-        for ( s = sample_index; s < sample_index + batch_size_; ++ s ) { 
-            for ( c = 0; c < n_channels_; ++c ) {
-                data->set_data_sample( data_sample_idx, c, loaded_data_[c][s] );
-            }
-            data->set_sample_timestamp(data_sample_idx, generated_hw_timestamps_[s] );
-            ++ data_sample_idx;
-        }
-        
-        data_port_->slot(0)->PublishData();
-        
-        sample_index += batch_size_;
+        stream_packet();
         
-        std::this_thread::sleep_for( delay );
+        // offline runs stream as fast as downstream processors allow
+        if (!context.offline()) { std::this_thread::sleep_for( delay ); }
     }  
 }
 
+StepResult MultichannelDataFileStreamer::ProcessStep( ProcessingContext& context ) {
+    
+    if (data_port_->slot(0)->nitems_produced() >= n_packets_to_dispatch_) { return StepResult::DONE; }
+    
+    // online steps are paced at streaming_rate, offline steps stream a
+    // packet on every call
+    if (!context.offline() && !pacer_.Due()) { return StepResult::IDLE; }
+    
+    stream_packet();
+    return StepResult::BUSY;
+}
+
 void MultichannelDataFileStreamer::Postprocess( ProcessingContext& context ) {
     
     LOG(INFO) << name()<< ". Streamed " << data_port_->slot(0)->nitems_produced()
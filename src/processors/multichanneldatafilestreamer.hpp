@@ -42,6 +42,7 @@
  * sample_rate <double> - sampling frequency of the loaded data 
  * batch_size <unsigned int> - # samples in each generated Multichannel Data item
  * streaming_rate <double> - (approximate) streaming rate of the each generated Multichannel Data item 
+ *   (ignored in offline runs)
  * initial_timestamp <uint64_t> - timestamp of the first data point
  * 
  */
@@ -52,6 +53,7 @@
 #include "../data/multichanneldata.hpp"
 #include "neuralynx/nlx.hpp"
 #include "npyreader/npyreader.h"
+#include "utilities/time.hpp"
 #include "../graph/iprocessor.hpp"
 
 
@@ -62,10 +64,17 @@ public:
     virtual void CreatePorts() override;
     virtual void CompleteStreamInfo() override;
     virtual void Prepare( GlobalContext& context ) override;
+    virtual void Preprocess( ProcessingContext& context ) override;
     virtual void Process( ProcessingContext& context ) override;
     virtual void Postprocess( ProcessingContext& context ) override;
     virtual void Unprepare( GlobalContext& context ) override;
     
+    virtual bool steppable() const override { return true; }
+    virtual StepResult ProcessStep( ProcessingContext& context ) override;
+    
+protected:
+    void stream_packet();
+    
 protected:
     PortOut<MultiChannelDataType<double>>* data_port_;
     
@@ -80,6 +89,8 @@ protected:
     size_t n_packets_to_dispatch_;
     double sampling_period_;
     std::vector<uint64_t> generated_hw_timestamps_;
+    unsigned int sample_index_; // first sample of the next packet
+    Pacer pacer_; // paces stepped packets
     
     FILE* fp_;
     double** loaded_data_; 
@@ -93,11 +93,30 @@ void MultiChannelFilter::Unprepare( GlobalContext& context ) {
     filters_.clear();
 }
 
+void MultiChannelFilter::filter_data( SlotType k, const MultiChannelData<double>* data_in ) {
+    
+    // claim output data buckets
+    MultiChannelData<double>* data_out = data_out_port_->slot(k)->ClaimData(false);
+    
+    // filter incoming data, sample by sample
+    for (unsigned int s=0; s<data_in->nsamples(); ++s) {
+        filters_[k]->process_sample(
+            data_in->begin_sample(s), data_out->begin_sample(s) );
+    }
+    
+    data_out->set_sample_timestamps( data_in->sample_timestamps() );
+    
+    data_out->CloneTimestamps( *data_in );
+    
+    // publish and release data
+    data_out_port_->slot(k)->PublishData();
+    data_in_port_->slot(k)->ReleaseData();
+}
+
 void MultiChannelFilter::Process( ProcessingContext& context ) {
     
     
     MultiChannelData<double>* data_in = nullptr;
-    MultiChannelData<double>* data_out = nullptr;
     
     auto nslots = data_in_port_->number_of_slots();
     decltype(nslots) k=0;
@@ -110,21 +129,26 @@ void MultiChannelFilter::Process( ProcessingContext& context ) {
             // retrieve new data
             if (!data_in_port_->slot(k)->RetrieveData( data_in )) {break;}
             
-            // claim output data buckets
-            data_out = data_out_port_->slot(k)->ClaimData(false);
-            
-            // filter incoming data               
-            filters_[k]->process_by_channel(
-                data_in->nsamples(), data_in->data(), data_out->data() );
-            
-            data_out->set_sample_timestamps( data_in->sample_timestamps() );
-            
-            data_out->CloneTimestamps( *data_in );
-            
-            // publish and release data
-            data_out_port_->slot(k)->PublishData();
-            data_in_port_->slot(k)->ReleaseData();
-            
+            filter_data( k, data_in );
         }      
     }
 }
+
+StepResult MultiChannelFilter::ProcessStep( ProcessingContext& context ) {
+    
+    MultiChannelData<double>* data_in = nullptr;
+    StepResult result = StepResult::IDLE;
+    
+    // filter one data bucket on every slot that has data ready
+    for (SlotType k=0; k<data_in_port_->number_of_slots(); ++k) {
+        
+        if (!data_in_port_->slot(k)->DataAvailable() || !data_out_port_->slot(k)->HasCapacity()) { continue; }
+        
+        if (!data_in_port_->slot(k)->RetrieveData( data_in )) { return StepResult::DONE; }
+        
+        filter_data( k, data_in );
+        result = StepResult::BUSY;
+    }
+    
+    return result;
+}
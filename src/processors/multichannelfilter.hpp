@@ -74,7 +74,13 @@ public:
     virtual void Prepare( GlobalContext& context ) override;
     virtual void Unprepare( GlobalContext& context ) override;
     virtual void Process( ProcessingContext& context ) override;
+    
+    virtual bool steppable() const override { return true; }
+    virtual StepResult ProcessStep( ProcessingContext& context ) override;
 
+protected:
+    void filter_data( SlotType slot, const MultiChannelData<double>* data_in );
+    
 protected:
     std::unique_ptr<dsp::filter::IFilter> filter_template_;
     std::vector<std::unique_ptr<dsp::filter::IFilter>> filters_;
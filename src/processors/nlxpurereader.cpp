@@ -48,7 +48,7 @@ void NlxPureReader::CreatePorts() {
     output_port_ = create_output_port(
         "udp",
         VectorDataType<char>( UDP_BUFFER_SIZE ),
-        PortOutPolicy( SlotRange(1), 500, WaitStrategy::kBlockingStrategy ) );
+        PortOutPolicy( SlotRange(1), 500, WaitStrategy::kFutexBlockingStrategy ) );
     
     n_invalid_ = create_writable_shared_state<int64_t>(
         "n_invalid",
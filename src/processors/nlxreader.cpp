@@ -75,8 +75,22 @@ void NlxReader::CreatePorts() {
         data_ports_[it.first] = create_output_port(
             it.first,
             MultiChannelDataType<double>( ChannelRange(it.second.size()) ),
-            PortOutPolicy( SlotRange(1), 500, WaitStrategy::kBlockingStrategy ) );
+            PortOutPolicy( SlotRange(1), 500, WaitStrategy::kFutexBlockingStrategy ) );
     }
+    
+    expose_method( "stats", &NlxReader::Stats );
+}
+
+YAML::Node NlxReader::Stats( const YAML::Node & node ) {
+    
+    YAML::Node result;
+    result["received"] = valid_packet_counter_;
+    result["invalid"] = stats_.n_invalid;
+    result["duplicated"] = stats_.n_duplicated;
+    result["outoforder"] = stats_.n_outoforder;
+    result["missed"] = stats_.n_missed;
+    result["gaps"] = stats_.n_gaps;
+    return result;
 }
 
 void NlxReader::CompleteStreamInfo() {
@@ -157,6 +171,13 @@ void NlxReader::Preprocess( ProcessingContext& context ) {
     
     stats_.clear_stats();
     
+    // publish all output ports together, so that downstream processors are
+    // only woken up once all buckets are available
+    publish_group_ = PublishGroup();
+    for (auto & it : data_ports_ ) {
+        publish_group_.Add( it.second );
+    }
+    
     if ( context.test() ) {
         prepare_latency_test( context );
     }
@@ -269,9 +290,7 @@ void NlxReader::Process( ProcessingContext& context ) {
             
             // publish data buckets
             if (sample_counter_ == batch_size_) {
-                for (auto & it : data_ports_ ) {
-                    it.second->slot(0)->PublishData();
-                }
+                publish_group_.Publish();
             }
             
         } // receive packet
@@ -31,7 +31,9 @@
  * none
  *
  * exposed methods:
- * none
+ * stats - returns the number of received packets and the packet error
+ *   counters (invalid, duplicated, out of order, missed, gaps) of the
+ *   current or last run
  *
  * options:
  * address <string> - IP address of Digilynx system
@@ -108,6 +110,7 @@ public:
 protected:
     bool CheckPacket(char * buffer, int recvlen);
     void print_stats( bool condition = true );
+    YAML::Node Stats( const YAML::Node & node );
     
 public:
     static constexpr uint16_t MAX_NCHANNELS = 128;
@@ -153,6 +156,7 @@ protected:
     decltype(timestamp_) delta_;
     
     std::map<std::string, PortOut<MultiChannelDataType<double>>*> data_ports_;
+    PublishGroup publish_group_;
     
 public:
     static constexpr decltype(NLX_SIGNAL_SAMPLING_FREQUENCY)
@@ -55,7 +55,7 @@ void OpenEphysReader::CreatePorts() {
         data_ports_[it.first] = create_output_port(
             it.first,
             MultiChannelDataType<double>( ChannelRange(it.second.size()) ),
-            PortOutPolicy( SlotRange(1), 500, WaitStrategy::kBlockingStrategy ) );
+            PortOutPolicy( SlotRange(1), 500, WaitStrategy::kFutexBlockingStrategy ) );
     }
 }
 
@@ -92,6 +92,8 @@ public:
     virtual void Process( ProcessingContext& context ) override;
     virtual void Postprocess( ProcessingContext& context ) override;
     virtual void Unprepare( GlobalContext& context ) override;
+    // the Opal Kelly board library is not thread-safe
+    virtual bool parallel_prepare() const override { return false; }
       
 protected:
     bool startAcquisition();
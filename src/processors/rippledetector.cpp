@@ -268,6 +268,7 @@ void RippleDetector::Process( ProcessingContext& context ) {
                 if ( stream_events_->get() ) {
                     event_out = event_out_port_->slot(0)->ClaimData(false);
                     event_out->set_source_timestamp( data_in->source_timestamp() );
+                    event_out->CloneTrace( *data_in );
                     event_out->set_hardware_timestamp( data_in->sample_timestamp( s ) );
                     event_out_port_->slot(0)->PublishData();
                 }
@@ -291,7 +292,7 @@ void RippleDetector::Postprocess( ProcessingContext& context ) {
         << " ripple events.";
 }
 
-inline double RippleDetector::compute_value( MultiChannelData<double>* data_in,
+inline double RippleDetector::compute_value( const MultiChannelData<double>* data_in,
     unsigned int sample ) {
     
     if ( use_power_ ) {
@@ -75,7 +75,7 @@ public:
     virtual void Postprocess( ProcessingContext& context ) override;
     
 protected:
-    double compute_value( MultiChannelData<double>* data_in, unsigned int sample );
+    double compute_value( const MultiChannelData<double>* data_in, unsigned int sample );
     
 protected:
     PortIn<MultiChannelDataType<double>>* data_in_port_;
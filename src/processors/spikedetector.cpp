@@ -103,16 +103,69 @@ void SpikeDetector::Prepare( GlobalContext& context ) {
     }
 }
 
-void SpikeDetector::Process( ProcessingContext& context ) {
+void SpikeDetector::Preprocess( ProcessingContext& context ) {
+    
+    single_spike_event_.reset( new EventData("spike") );
+    multiple_spikes_event_.reset( new EventData("spikes") );
+    
+    sample_buffer_counter_ = 0;
+    hw_timestamp_ = 0;
+}
+
+void SpikeDetector::detect_spikes() {
     
-    decltype(n_incoming_) sample_buffer_counter = 0;
-    decltype(data_in_->hardware_timestamp()) hw_timestamp = 0;
     decltype(incoming_buffer_size_samples_) s = 0;
     decltype(n_channels_) c =0;
-    decltype(data_in_) signals = nullptr;
+    const MultiChannelData<double>* signals = nullptr;
     
-    std::unique_ptr<EventData> single_spike_event( new EventData("spike") );
-    std::unique_ptr<EventData> multiple_spikes_event( new EventData("spikes") );
+    // if spike detection has to be performed on the inverted signal,
+    // make a local copy of the inverted signal and use it for spike detection
+    if ( invert_signal_ ) {
+        for ( s = 0; s < incoming_buffer_size_samples_; ++s ) {
+            for ( c=0; c < n_channels_; ++c ) {
+                inverted_signals_->set_data_sample(s, c,
+                    -data_in_->data_sample(s, c));
+            }
+        }
+        signals = inverted_signals_;
+    } else {
+        signals = data_in_;
+    }
+
+    // detect spikes sample by sample and collect each detected spike
+    for ( s = 0; s < incoming_buffer_size_samples_; ++s ) {
+        
+        if ( spike_detector_->is_spike<const double*>(
+            data_in_->sample_timestamp(s), signals->begin_sample(s)) ) {
+            
+            spike_data_out_->add_spike(
+                spike_detector_->amplitudes_detected_spike(),
+                spike_detector_->timestamp_detected_spike() );
+        }
+    }
+}
+
+void SpikeDetector::publish_spikes( uint64_t hw_timestamp ) {
+    
+    // publish results on the two ports
+    data_out_port_spikes_->slot(0)->PublishData();
+    if (spike_data_out_->n_detected_spikes() > 0) {    
+        event_data_out_ = data_out_port_events_->slot(0)->ClaimData( false );
+        if (spike_data_out_->n_detected_spikes() > 1) {
+            event_data_out_->set_event( *multiple_spikes_event_ );
+        } else {
+            event_data_out_->set_event( *single_spike_event_ );
+        }
+        event_data_out_->set_hardware_timestamp( hw_timestamp );
+        
+        data_out_port_events_->slot(0)->PublishData();
+    }
+}
+
+void SpikeDetector::Process( ProcessingContext& context ) {
+    
+    decltype(n_incoming_) sample_buffer_counter = 0;
+    decltype(data_in_->hardware_timestamp()) hw_timestamp = 0;
     
     while (!context.terminated()) {
         
@@ -133,31 +186,7 @@ void SpikeDetector::Process( ProcessingContext& context ) {
                 hw_timestamp = data_in_->hardware_timestamp();
             }
             
-            // if spike detection has to be performed on the inverted signal,
-            // make a local copy of the inverted signal and use it for spike detection
-            if ( invert_signal_ ) {
-                for ( s = 0; s < incoming_buffer_size_samples_; ++s ) {
-                    for ( c=0; c < n_channels_; ++c ) {
-                        inverted_signals_->set_data_sample(s, c,
-                            -data_in_->data_sample(s, c));
-                    }
-                }
-                signals = inverted_signals_;
-            } else {
-                signals = data_in_;
-            }
-
-            // detect spikes sample by sample and collect each detected spike
-            for ( s = 0; s < incoming_buffer_size_samples_; ++s ) {
-                
-                if ( spike_detector_->is_spike<double*>(
-                    data_in_->sample_timestamp(s), signals->begin_sample(s)) ) {
-                    
-                    spike_data_out_->add_spike(
-                        spike_detector_->amplitudes_detected_spike(),
-                        spike_detector_->timestamp_detected_spike() );
-                }
-            }
+            detect_spikes();
             
             // update counters and timestamp data
             ++ sample_buffer_counter;
@@ -167,23 +196,57 @@ void SpikeDetector::Process( ProcessingContext& context ) {
             data_in_port_->slot(0)->ReleaseData();
         }
         
-        // publish results on the two ports
-        data_out_port_spikes_->slot(0)->PublishData();
+        publish_spikes( hw_timestamp );
         sample_buffer_counter = 0;
-        if (spike_data_out_->n_detected_spikes() > 0) {    
-            event_data_out_ = data_out_port_events_->slot(0)->ClaimData( false );
-            if (spike_data_out_->n_detected_spikes() > 1) {
-                event_data_out_->set_event( *multiple_spikes_event );
-            } else {
-                event_data_out_->set_event( *single_spike_event );
-            }
-            event_data_out_->set_hardware_timestamp( hw_timestamp );
-            
-            data_out_port_events_->slot(0)->PublishData();
-        }     
     }
 }
 
+StepResult SpikeDetector::ProcessStep( ProcessingContext& context ) {
+    
+    if (!data_in_port_->slot(0)->DataAvailable()) { return StepResult::IDLE; }
+    
+    // make sure that neither claim will block
+    if (sample_buffer_counter_ == 0 &&
+        (!data_out_port_spikes_->slot(0)->HasCapacity() ||
+         !data_out_port_events_->slot(0)->HasCapacity())) {
+        return StepResult::IDLE;
+    }
+    
+    // check for the end of the stream before claiming, such that no claim is
+    // left open; a partial bin is published as in Process
+    if (!data_in_port_->slot(0)->RetrieveData( data_in_ )) {
+        if (sample_buffer_counter_ > 0) {
+            publish_spikes( hw_timestamp_ );
+            sample_buffer_counter_ = 0;
+        }
+        return StepResult::DONE;
+    }
+    
+    if (sample_buffer_counter_ == 0) {
+        // update state variables
+        spike_detector_->set_threshold( threshold_->get() );
+        spike_detector_->set_peak_life_time( peak_lifetime_->get() );
+        
+        spike_data_out_ = data_out_port_spikes_->slot(0)->ClaimData( true );
+        hw_timestamp_ = data_in_->hardware_timestamp();
+    }
+    
+    detect_spikes();
+    
+    ++ sample_buffer_counter_;
+    spike_data_out_->set_hardware_timestamp( hw_timestamp_ );
+    spike_data_out_->set_source_timestamp();
+    
+    data_in_port_->slot(0)->ReleaseData();
+    
+    if (sample_buffer_counter_ == n_incoming_) {
+        publish_spikes( hw_timestamp_ );
+        sample_buffer_counter_ = 0;
+    }
+    
+    return StepResult::BUSY;
+}
+
 void SpikeDetector::Postprocess( ProcessingContext& context ) {
     
     LOG(INFO) << name() << ". # spikes detected = " << spike_detector_->nspikes();
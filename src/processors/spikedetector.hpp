@@ -63,9 +63,17 @@ public:
     virtual void CreatePorts( ) override;
     virtual void CompleteStreamInfo() override;
     virtual void Prepare( GlobalContext& context ) override;
+    virtual void Preprocess( ProcessingContext& context ) override;
     virtual void Process( ProcessingContext& context ) override;
     virtual void Postprocess( ProcessingContext& context ) override; 
     virtual void Unprepare( GlobalContext& context ) override;
+    
+    virtual bool steppable() const override { return true; }
+    virtual StepResult ProcessStep( ProcessingContext& context ) override;
+
+protected:
+    void detect_spikes();
+    void publish_spikes( uint64_t hw_timestamp );
 
 protected:
     PortIn<MultiChannelDataType<double>>* data_in_port_;
@@ -91,6 +99,13 @@ protected:
     SpikeData* spike_data_out_;
     EventData* event_data_out_;
     
+    std::unique_ptr<EventData> single_spike_event_;
+    std::unique_ptr<EventData> multiple_spikes_event_;
+    
+    // state of step-wise processing
+    size_t sample_buffer_counter_;
+    uint64_t hw_timestamp_;
+    
     uint64_t n_streamed_events_;
     
 public:
@@ -209,46 +209,54 @@ void SpikeStreamer::Prepare( GlobalContext& context ) {
     fclose(fp_initial_times); fp_initial_times = nullptr;
 }
 
+void SpikeStreamer::Preprocess( ProcessingContext& context ) {
+    
+    spike_index_ = 0;
+    // the first value is not a boundary to the next temporal bin    
+    time_limit_cursor_ = 1;
+    pacer_.Start( streaming_rate_ );
+}
+
+void SpikeStreamer::stream_packet() {
+    
+    SpikeData* data = data_out_port_->slot(0)->ClaimData( true );
+    assert( data->n_detected_spikes() == data->ts_detected_spikes().size());
+    assert( data->n_detected_spikes() == 0 );
+    
+    while ( spike_index_ < n_spikes_ &&
+            loaded_spike_times_[spike_index_] < time_limits_[time_limit_cursor_] ) {
+        
+        data->add_spike( &loaded_spike_amplitudes_[spike_index_ * n_channels_],
+            static_cast<uint64_t>( std::round( loaded_spike_times_[spike_index_]*1e6 ) ) );
+        ++ spike_index_;
+    }
+    
+    data->set_hardware_timestamp(
+        static_cast<uint64_t>(std::round( time_limits_[time_limit_cursor_-1]*1e6 )));
+    data->set_source_timestamp();
+    ++ time_limit_cursor_;
+    
+    if ( data->n_detected_spikes() != data->ts_detected_spikes().size() ) {
+        
+        LOG(ERROR) << name() << ". data->n_detected_spikes() = " <<
+        data->n_detected_spikes() << ". data->ts_detected_spikes().size() = "
+        << data->ts_detected_spikes().size();
+    }
+    data_out_port_->slot(0)->PublishData();
+}
+
 void SpikeStreamer::Process(ProcessingContext& context) {
     
-    SpikeData* data = nullptr;
     auto delay = std::chrono::microseconds(
         static_cast<unsigned int>( 1e6 / streaming_rate_ ) );
-    decltype(n_spikes_) n = 0;
-  
-    // the first value is not a boundary to the next temporal bin    
-    unsigned int time_limit_cursor = 1;
     
     while ( !context.terminated() &&
             data_out_port_->slot(0)->nitems_produced() < n_packets_to_stream_ ) {
         
-        data = data_out_port_->slot(0)->ClaimData( true );
-        assert( data->n_detected_spikes() == data->ts_detected_spikes().size());
-        assert( data->n_detected_spikes() == 0 );
-        
-        
-        while ( loaded_spike_times_[n] < time_limits_[time_limit_cursor] && 
-                n < n_spikes_) {
-            
-            data->add_spike( &loaded_spike_amplitudes_[n * n_channels_],
-                static_cast<uint64_t>( std::round( loaded_spike_times_[n]*1e6 ) ) );
-            ++ n;
-        }
-        
-        data->set_hardware_timestamp(
-            static_cast<uint64_t>(std::round( time_limits_[time_limit_cursor-1]*1e6 )));
-        data->set_source_timestamp();
-        ++ time_limit_cursor;
-        
-        if ( data->n_detected_spikes() != data->ts_detected_spikes().size() ) {
-            
-            LOG(ERROR) << name() << ". data->n_detected_spikes() = " <<
-            data->n_detected_spikes() << ". data->ts_detected_spikes().size() = "
-            << data->ts_detected_spikes().size();
-        }
-        data_out_port_->slot(0)->PublishData();
+        stream_packet();
         
-        std::this_thread::sleep_for( delay );
+        // offline runs stream as fast as downstream processors allow
+        if (!context.offline()) { std::this_thread::sleep_for( delay ); }
     }  
     
     // this log goes here (and in PostProcess) so that the STOP commands
@@ -257,6 +265,22 @@ void SpikeStreamer::Process(ProcessingContext& context) {
         << " data packets. PRESS 's' to STOP THE GRAPH";
 }
 
+StepResult SpikeStreamer::ProcessStep( ProcessingContext& context ) {
+    
+    if (data_out_port_->slot(0)->nitems_produced() >= n_packets_to_stream_) {
+        LOG(INFO) << name()<< ". Streamed " << data_out_port_->slot(0)->nitems_produced()
+            << " data packets.";
+        return StepResult::DONE;
+    }
+    
+    // online steps are paced at streaming_rate, offline steps stream a
+    // packet on every call
+    if (!context.offline() && !pacer_.Due()) { return StepResult::IDLE; }
+    
+    stream_packet();
+    return StepResult::BUSY;
+}
+
 void SpikeStreamer::Unprepare( GlobalContext& context ) {
 
     free(loaded_spike_amplitudes_); loaded_spike_amplitudes_ = nullptr;
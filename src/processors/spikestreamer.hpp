@@ -62,6 +62,7 @@
  * buffer_size_ms <double> - buffer size of the generated spike data item [ms]
  * sample_rate <double> - sample rate of the signal used for detecting the loaded spikes
  * streaming_rate <double> - (approximate) streaming rate of each generated SpikeData item 
+ *   (ignored in offline runs)
  * 
  */
 
@@ -71,6 +72,7 @@
 #include "../graph/iprocessor.hpp"
 #include "../data/spikedata.hpp"
 #include "neuralynx/nlx.hpp"
+#include "utilities/time.hpp"
 
 #include <limits>
 
@@ -82,8 +84,15 @@ public:
     virtual void CreatePorts() override;
     virtual void CompleteStreamInfo() override;
     virtual void Prepare( GlobalContext& context ) override;
+    virtual void Preprocess( ProcessingContext& context ) override;
     virtual void Process( ProcessingContext& context ) override;
     virtual void Unprepare( GlobalContext& context ) override;  
+    
+    virtual bool steppable() const override { return true; }
+    virtual StepResult ProcessStep( ProcessingContext& context ) override;
+
+protected:
+    void stream_packet();
 
 protected:
     PortOut<SpikeDataType>* data_out_port_;
@@ -107,6 +116,10 @@ protected:
     std::vector<double> time_limits_;
     uint32_t n_bins_;
     
+    uint32_t spike_index_; // next spike to stream
+    unsigned int time_limit_cursor_; // upper time limit of the next packet
+    Pacer pacer_; // paces stepped packets
+    
     const double ERROR_ = 1e5 * std::numeric_limits<double>::epsilon();
 
 public:
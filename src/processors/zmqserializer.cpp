@@ -29,6 +29,9 @@ void ZMQSerializer::CreatePorts() {
         "data",
         AnyDataType(),
         PortInPolicy( SlotRange(1,256), false, 0 ) );
+    
+    // sleep on all slots at once, rather than spinning over them
+    data_port_->enable_wait_any();
 }
 
 void ZMQSerializer::Configure( const YAML::Node & node, const GlobalContext& context ) {
@@ -74,7 +77,7 @@ void ZMQSerializer::Preprocess(ProcessingContext& context) {
 
 void ZMQSerializer::Process(ProcessingContext& context) {
       
-    std::vector<IData*> data;
+    DataView<IData> data;
     
     int nslots = data_port_->number_of_slots();
     
@@ -83,13 +86,17 @@ void ZMQSerializer::Process(ProcessingContext& context) {
     
     while (!context.terminated()) {
         
+        if (data_port_->WaitAny( WAIT_TIME_OUT_US )<0) { continue; }
+        
         for (int k=0; k<nslots; ++k) {
             
+            if (!data_port_->slot(k)->DataAvailable()) { continue; }
+            
             if (!data_port_->slot(k)->RetrieveDataAll( data )) {break;}
             
             if (!interleave_) {idx=k;}
             
-            for (auto & it : data) {
+            for (auto it : data) {
                 
                 buffer.str("");
                 buffer.clear();
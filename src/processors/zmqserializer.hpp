@@ -73,6 +73,8 @@ public:
     const Serialization::Format DEFAULT_FORMAT = Serialization::Format::FULL;
     const unsigned int DEFAULT_PORT = 7777;
     const bool DEFAULT_INTERLEAVE = false;
+    // maximum time to sleep while waiting for data, in microseconds
+    const int64_t WAIT_TIME_OUT_US = 100000;
 };
 
 #endif //zmqserializer.hpp
@@ -38,6 +38,7 @@ typedef disruptor::Sequence RingSequence;
 
 typedef disruptor::ClaimStrategyOption ClaimStrategy;
 typedef disruptor::WaitStrategyOption WaitStrategy;
+typedef disruptor::WaitStrategyParameters WaitParameters;
 typedef disruptor::AlertException RingAlertException;
 
 typedef disruptor::BatchDescriptor RingBatch;
@@ -0,0 +1,310 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+/* bench_ringbuffer: microbenchmark of the ring buffer transport
+ * 
+ * A producer thread claims MultiChannelData items in a ring buffer, fills
+ * them and publishes them to one or more consumer threads, which wait on
+ * the ring buffer and read the items, the same way output and input slots
+ * use the ring buffer in a processor graph.
+ * 
+ * For every combination of item size, number of consumers, wait strategy
+ * and thread pinning, two runs are made:
+ * - throughput: the producer publishes as fast as the consumers allow
+ * - latency: the producer publishes at a fixed rate and the consumers
+ *   record the one-way latency (publication to retrieval) of every item
+ * 
+ * Results are written to standard output as YAML, progress to standard
+ * error.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "cmdline/cmdline.h"
+#include "utilities/string.hpp"
+#include "yaml-cpp/yaml.h"
+
+#include "../src/ringbuffer.hpp"
+#include "../src/data/multichanneldata.hpp"
+#include "../src/graph/portpolicy.hpp"
+
+typedef MultiChannelDataType<double> BenchDataType;
+typedef MultiChannelData<double> BenchData;
+
+struct BenchConfig {
+    std::size_t nsamples;
+    std::size_t nchannels;
+    unsigned int nconsumers;
+    WaitStrategy wait_strategy;
+    bool pinned;
+    int buffer_size;
+    std::vector<int> cores; // producer first, then the consumers
+};
+
+struct ConsumerResult {
+    std::vector<int64_t> latency_ns; // latency runs only
+    double checksum = 0; // keeps the reads of the payload alive
+};
+
+namespace {
+
+int64_t now_ns() {
+    
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch() ).count();
+}
+
+void pin_thread( const BenchConfig& config, unsigned int index ) {
+    
+    if (!config.pinned) { return; }
+    
+    cpu_set_t cpuset;
+    CPU_ZERO( &cpuset );
+    CPU_SET( config.cores[index % config.cores.size()], &cpuset );
+    if (pthread_setaffinity_np( pthread_self(), sizeof(cpu_set_t), &cpuset )!=0) {
+        std::cerr << "Could not pin thread to core " << config.cores[index % config.cores.size()] << std::endl;
+    }
+}
+
+// one producer, config.nconsumers consumers; if interval_ns>0 the producer
+// publishes one item per interval and consumers record latencies
+double run( const BenchConfig& config, uint64_t nitems, int64_t interval_ns,
+    std::vector<ConsumerResult>& results ) {
+    
+    BenchDataType datatype( config.nchannels );
+    datatype.Finalize( config.nsamples, config.nchannels, 1.0 );
+    DataFactory<BenchDataType> factory( datatype );
+    
+    RingBuffer<BenchData> ringbuffer( &factory, config.buffer_size,
+        ClaimStrategy::kSingleThreadedStrategy, config.wait_strategy );
+    
+    std::vector<std::unique_ptr<RingSequence>> sequences;
+    std::vector<RingSequence*> gating;
+    for (unsigned int k=0; k<config.nconsumers; ++k) {
+        sequences.emplace_back( new RingSequence() );
+        gating.push_back( sequences.back().get() );
+    }
+    ringbuffer.set_gating_sequences( gating );
+    
+    results.assign( config.nconsumers, ConsumerResult() );
+    std::atomic<unsigned int> ready( 0 );
+    
+    std::vector<std::thread> consumers;
+    for (unsigned int k=0; k<config.nconsumers; ++k) {
+        consumers.emplace_back( [&, k]() {
+            
+            pin_thread( config, k+1 );
+            std::unique_ptr<RingBarrier> barrier( ringbuffer.NewBarrier( std::vector<RingSequence*>(0) ) );
+            ConsumerResult& result = results[k];
+            if (interval_ns>0) { result.latency_ns.reserve( nitems ); }
+            
+            ready.fetch_add( 1 );
+            
+            int64_t next = 0;
+            while (next < (int64_t) nitems) {
+                int64_t available = barrier->WaitFor( next );
+                int64_t retrieved = now_ns();
+                for (int64_t s=next; s<=available; ++s) {
+                    const BenchData* item = ringbuffer.Get( s );
+                    if (interval_ns>0) {
+                        result.latency_ns.push_back( retrieved - std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            item->source_timestamp().time_since_epoch() ).count() );
+                    }
+                    for (std::size_t sample=0; sample<item->nsamples(); ++sample) {
+                        result.checksum += item->sum_sample( sample );
+                    }
+                }
+                sequences[k]->set_sequence( available );
+                next = available + 1;
+            }
+        } );
+    }
+    
+    pin_thread( config, 0 );
+    while (ready.load() < config.nconsumers) { std::this_thread::yield(); }
+    
+    RingBatch batch( 1 );
+    int64_t start = now_ns();
+    int64_t next_publication = start;
+    
+    for (uint64_t n=0; n<nitems; ++n) {
+        if (interval_ns>0) {
+            next_publication += interval_ns;
+            while (now_ns() < next_publication) {}
+        }
+        ringbuffer.Next( &batch );
+        BenchData* item = ringbuffer.Get( batch.end() );
+        for (std::size_t sample=0; sample<item->nsamples(); ++sample) {
+            std::fill( item->begin_sample( sample ), item->end_sample( sample ), (double) n );
+        }
+        item->set_source_timestamp();
+        ringbuffer.Publish( batch );
+    }
+    
+    for (auto & consumer : consumers) { consumer.join(); }
+    
+    return (now_ns() - start) * 1e-9;
+}
+
+YAML::Node latency_percentiles( std::vector<ConsumerResult>& results ) {
+    
+    std::vector<int64_t> latency;
+    for (auto & result : results) {
+        latency.insert( latency.end(), result.latency_ns.begin(), result.latency_ns.end() );
+    }
+    
+    YAML::Node node;
+    if (latency.empty()) { return node; }
+    
+    std::sort( latency.begin(), latency.end() );
+    auto percentile = [&latency]( double p ) {
+        return latency[ std::min( latency.size()-1, (std::size_t)( p/100.0 * latency.size() ) ) ];
+    };
+    
+    node["p50"] = percentile( 50 );
+    node["p90"] = percentile( 90 );
+    node["p99"] = percentile( 99 );
+    node["p99.9"] = percentile( 99.9 );
+    node["max"] = latency.back();
+    return node;
+}
+
+template <typename T>
+std::vector<T> parse_list( std::string value ) {
+    
+    std::vector<T> list;
+    for (auto & item : split( value, ',' )) {
+        if (!item.empty()) { list.push_back( YAML::Load( item ).as<T>() ); }
+    }
+    return list;
+}
+
+}
+
+int main(int argc, char** argv) {
+    
+    cmdline::parser parser;
+    
+    parser.add<uint64_t>("n_items", 'n', "number of items per throughput run", false, 1000000 );
+    parser.add<uint64_t>("n_latency_items", 'l', "number of items per latency run", false, 100000 );
+    parser.add<double>("rate", 'r', "publication rate of latency runs (items/s)", false, 20000 );
+    parser.add<int>("buffer_size", 'b', "number of slots in the ring buffer", false, 256 );
+    parser.add<std::string>("sizes", 's', "item sizes as samples x channels", false, "1x4,1x32,1x128,32x4,32x32,32x128" );
+    parser.add<std::string>("consumers", 'c', "numbers of consumers (1 is single producer, single consumer)", false, "1,4" );
+    parser.add<std::string>("wait_strategies", 'w', "wait strategies", false, "blocking,sleeping,yielding,busyspin,hybrid,futex" );
+    parser.add<std::string>("pinning", 'p', "thread pinning: pinned, unpinned or both", false, "both",
+        cmdline::oneof<std::string>( "pinned", "unpinned", "both" ) );
+    parser.add<std::string>("cores", '\0', "cores for pinned threads, producer first (default: 0,1,2,...)", false, "" );
+    
+    parser.parse_check(argc, argv);
+    
+    int ncores = std::thread::hardware_concurrency();
+    
+    std::vector<int> cores = parse_list<int>( parser.get<std::string>("cores") );
+    if (cores.empty()) {
+        for (int k=0; k<ncores; ++k) { cores.push_back( k ); }
+    }
+    
+    std::vector<std::pair<std::size_t,std::size_t>> sizes;
+    for (auto & size : split( parser.get<std::string>("sizes"), ',' )) {
+        auto parts = split( size, 'x' );
+        if (parts.size()!=2) {
+            std::cerr << "Invalid item size \"" << size << "\" (should be samples x channels)." << std::endl;
+            return EXIT_FAILURE;
+        }
+        sizes.emplace_back( std::stoul( parts[0] ), std::stoul( parts[1] ) );
+    }
+    
+    std::vector<int> pinning;
+    if (parser.get<std::string>("pinning")!="unpinned") { pinning.push_back( true ); }
+    if (parser.get<std::string>("pinning")!="pinned") { pinning.push_back( false ); }
+    
+    uint64_t nitems = parser.get<uint64_t>("n_items");
+    uint64_t nlatency = parser.get<uint64_t>("n_latency_items");
+    int64_t interval_ns = 1e9 / parser.get<double>("rate");
+    
+    YAML::Node output;
+    output["cores"] = ncores;
+    output["buffer_size"] = parser.get<int>("buffer_size");
+    output["latency_rate"] = parser.get<double>("rate");
+    
+    for (auto & size : sizes) {
+        for (auto nconsumers : parse_list<unsigned int>( parser.get<std::string>("consumers") )) {
+            for (auto & wait : split( parser.get<std::string>("wait_strategies"), ',' )) {
+                for (bool pinned : pinning) {
+                    
+                    BenchConfig config{ size.first, size.second, nconsumers,
+                        wait_strategy_from_string( wait ), pinned,
+                        parser.get<int>("buffer_size"), cores };
+                    
+                    YAML::Node result;
+                    result["samples"] = size.first;
+                    result["channels"] = size.second;
+                    result["item_bytes"] = size.first * size.second * sizeof(double);
+                    result["consumers"] = nconsumers;
+                    result["wait_strategy"] = wait_strategy_to_string( config.wait_strategy );
+                    result["pinned"] = pinned;
+                    
+                    // spinning threads that share a core never make progress
+                    if (config.wait_strategy==WaitStrategy::kBusySpinStrategy && (int)nconsumers+1 > ncores) {
+                        result["skipped"] = "more threads than cores";
+                        output["results"].push_back( result );
+                        continue;
+                    }
+                    
+                    std::cerr << size.first << "x" << size.second << ", " << nconsumers << " consumer(s), "
+                        << wait << ", " << (pinned ? "pinned" : "unpinned") << std::endl;
+                    
+                    std::vector<ConsumerResult> results;
+                    double checksum = 0;
+                    
+                    double seconds = run( config, nitems, 0, results );
+                    result["throughput"] = nitems / seconds;
+                    for (auto & r : results) { checksum += r.checksum; }
+                    
+                    run( config, nlatency, interval_ns, results );
+                    result["latency_ns"] = latency_percentiles( results );
+                    for (auto & r : results) { checksum += r.checksum; }
+                    
+                    result["checksum"] = checksum;
+                    
+                    output["results"].push_back( result );
+                }
+            }
+        }
+    }
+    
+    YAML::Emitter out;
+    out << output;
+    std::cout << out.c_str() << std::endl;
+    
+    return EXIT_SUCCESS;
+}
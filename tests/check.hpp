@@ -0,0 +1,63 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+
+#ifndef TESTS_CHECK_HPP
+#define TESTS_CHECK_HPP
+
+/* minimal checks for the behaviour tests in this directory
+ * 
+ * EXPECT reports a failed condition with its location and continues, such
+ * that a single run lists all failures. Tests return check_result() from
+ * main, which is non-zero if any check failed. (CHECK is defined by g3log.)
+ */
+
+#include <iostream>
+
+namespace testing {
+
+inline unsigned int& nfailures() {
+    
+    static unsigned int n = 0;
+    return n;
+}
+
+inline void check( bool condition, const char* expression, const char* file, int line ) {
+    
+    if (!condition) {
+        std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+        ++nfailures();
+    }
+}
+
+inline int check_result( const char* name ) {
+    
+    if (nfailures()==0) {
+        std::cout << name << ": all checks passed." << std::endl;
+        return 0;
+    }
+    std::cout << name << ": " << nfailures() << " check(s) failed." << std::endl;
+    return 1;
+}
+
+} // namespace testing
+
+#define EXPECT( condition ) testing::check( (condition), #condition, __FILE__, __LINE__ )
+
+#endif // check.hpp
@@ -0,0 +1,191 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+
+/* test_lazyclear: behaviour of lazily cleared data items
+ * 
+ * MultiChannelData only resets the samples that were written through its
+ * non-const accessors since the last clear. LikelihoodData defers the reset
+ * of its log likelihood to first use or to publication (PrepareForPublish).
+ * In both cases a cleared item has to look fully reset to its producer and
+ * to the readers of the published item.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "../src/data/multichanneldata.hpp"
+#include "../src/data/likelihooddata.hpp"
+
+typedef MultiChannelData<double> Signal;
+
+const size_t NCHANNELS = 4;
+const size_t NSAMPLES = 8;
+
+bool all_zero( const Signal& data ) {
+    
+    const auto& values = data.data();
+    const auto& timestamps = data.sample_timestamps();
+    return std::all_of( values.begin(), values.end(), []( double v ) { return v==0; } ) &&
+        std::all_of( timestamps.begin(), timestamps.end(), []( uint64_t t ) { return t==0; } );
+}
+
+// readers that do not go through the dirty tracking (e.g. a bug, or a
+// reader of a published item that writes nonetheless)
+double& untracked( Signal& data, size_t sample, size_t channel ) {
+    
+    const Signal& view = data;
+    return const_cast<double&>( view( sample, channel ) );
+}
+
+void test_multichannel_writers() {
+    
+    std::vector<double> channel_values( NSAMPLES, 1.0 );
+    std::vector<double> sample_values( NCHANNELS, 2.0 );
+    
+    // every non-const accessor marks what it writes, such that a clear resets it
+    std::vector<std::pair<std::string, std::function<void(Signal&)>>> writers = {
+        { "operator()(sample, channel)", []( Signal& d ) { d( 5, 2 ) = 3; } },
+        { "set_data_sample", []( Signal& d ) { d.set_data_sample( 6, 1, 3 ); } },
+        { "set_data_sample(vector)", [&]( Signal& d ) { d.set_data_sample( 4, sample_values ); } },
+        { "set_data_channel", [&]( Signal& d ) { d.set_data_channel( 1, channel_values ); } },
+        { "begin_sample", []( Signal& d ) { std::fill( d.begin_sample( 3 ), d.end_sample( 3 ), 4 ); } },
+        { "begin_channel", []( Signal& d ) { std::fill( d.begin_channel( 2 ), d.end_channel( 2 ), 5 ); } },
+        { "data", []( Signal& d ) { d.data()[ NCHANNELS*NSAMPLES-1 ] = 6; } },
+        { "set_sample_timestamp", []( Signal& d ) { d.set_sample_timestamp( 2, 99 ); } },
+        { "sample_timestamps", []( Signal& d ) { d.sample_timestamps()[ NSAMPLES-1 ] = 99; } },
+    };
+    
+    for (auto & writer : writers) {
+        Signal data;
+        data.Initialize( NCHANNELS, NSAMPLES, 1000. );
+        data.ClearData();
+        
+        writer.second( data );
+        EXPECT( !all_zero( data ) );
+        
+        data.ClearData();
+        if (!all_zero( data )) {
+            std::cerr << "not cleared after " << writer.first << std::endl;
+        }
+        EXPECT( all_zero( data ) );
+    }
+}
+
+void test_multichannel_dirty_range() {
+    
+    Signal data;
+    data.Initialize( NCHANNELS, NSAMPLES, 1000. );
+    data.ClearData();
+    
+    // only the written samples are reset: a value that was written without
+    // tracking outside of the dirty range survives the clear
+    data( 2, 0 ) = 1;
+    data( 3, 3 ) = 1;
+    untracked( data, 6, 1 ) = 7;
+    
+    data.ClearData();
+    EXPECT( data( 2, 0 )==0 );
+    EXPECT( data( 3, 3 )==0 );
+    EXPECT( data.data_sample( 6, 1 )==7 );
+    
+    // a clear without writes in between resets nothing
+    untracked( data, 0, 0 ) = 8;
+    data.ClearData();
+    EXPECT( data.data_sample( 0, 0 )==8 );
+    
+    // reading through the const accessors does not mark anything
+    const Signal& reader = data;
+    double sum = 0;
+    for (size_t s=0; s<NSAMPLES; ++s) {
+        sum += std::accumulate( reader.begin_sample( s ), reader.end_sample( s ), 0.0 );
+    }
+    sum += std::accumulate( reader.begin_channel( 1 ), reader.end_channel( 1 ), 0.0 );
+    sum += reader.sample_timestamp( 0 ) + reader.data()[0];
+    EXPECT( sum > 0 );
+    data.ClearData();
+    EXPECT( data.data_sample( 6, 1 )==7 );
+    EXPECT( data.data_sample( 0, 0 )==8 );
+    
+    // initialization marks everything
+    data.Initialize( NCHANNELS, NSAMPLES, 1000. );
+    data.ClearData();
+    EXPECT( all_zero( data ) );
+}
+
+// exposes the deferred clear
+class InspectableLikelihood : public LikelihoodData {
+public:
+    bool clear_pending() const { return log_likelihood_cleared_; }
+};
+
+void test_likelihood_clear() {
+    
+    const size_t GRID = 16;
+    
+    InspectableLikelihood data;
+    data.Initialize( GRID );
+    
+    std::vector<double> values( GRID, 2.5 );
+    data.set_log_likelihood( values.data(), GRID );
+    EXPECT( data.log_likelihood()[3]==2.5 );
+    
+    // clearing is deferred
+    data.ClearData();
+    EXPECT( data.clear_pending() );
+    EXPECT( data.n_spikes()==0 );
+    
+    // the output slot completes the clear before publication, such that
+    // readers never need to write to the published item
+    data.PrepareForPublish();
+    EXPECT( !data.clear_pending() );
+    const LikelihoodData& reader = data;
+    for (size_t g=0; g<GRID; ++g) {
+        EXPECT( reader.log_likelihood()[g]==LikelihoodData::DEFAULT_LOG_LIKELIHOOD_VALUE );
+    }
+    
+    // a partial write after a clear sees the reset values elsewhere
+    data.set_log_likelihood( values.data(), GRID );
+    data.ClearData();
+    data.increment_loglikelihood( 1.0, 5 );
+    EXPECT( !data.clear_pending() );
+    EXPECT( data.log_likelihood()[5]==LikelihoodData::DEFAULT_LOG_LIKELIHOOD_VALUE + 1.0 );
+    EXPECT( data.log_likelihood()[4]==LikelihoodData::DEFAULT_LOG_LIKELIHOOD_VALUE );
+    
+    // a full write after a clear needs no reset
+    data.ClearData();
+    data.set_log_likelihood( values.data(), GRID );
+    EXPECT( !data.clear_pending() );
+    EXPECT( data.log_likelihood()[0]==2.5 );
+}
+
+int main( int argc, char** argv ) {
+    
+    test_multichannel_writers();
+    test_multichannel_dirty_range();
+    test_likelihood_clear();
+    
+    return testing::check_result( "test_lazyclear" );
+}
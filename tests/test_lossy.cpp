@@ -0,0 +1,141 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+
+/* test_lossy: behaviour of lossy input slots
+ * 
+ * A lossy input slot does not gate its producer. When its backlog exceeds
+ * three quarters of the ring buffer it skips ahead to the newest items,
+ * counting the skipped items as dropped; items that the producer overwrote
+ * while they were in use are counted as overwritten.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "testprocessors.hpp"
+#include "../src/graph/processorgraph.hpp"
+
+const char* GRAPH = R"(
+processors:
+    source:
+        class: TestSource
+        advanced:
+            buffer_sizes: {data: 16}
+    sink:
+        class: TestSink
+        advanced:
+            lossy: [data]
+connections:
+    - source.data=sink.data
+)";
+
+template <typename PROCESSOR>
+PROCESSOR* processor( graph::ProcessorGraph& g, std::string name ) {
+    
+    return dynamic_cast<PROCESSOR*>( g.processors().at( name ).second->processor() );
+}
+
+void publish( SlotOut<TestDataType>* slot, double& next, unsigned int n ) {
+    
+    for (unsigned int k=0; k<n; ++k) {
+        slot->ClaimData( false )->set_data( next++ );
+        slot->PublishData();
+    }
+}
+
+void test_skip_overrun( GlobalContext& context, bool lossy ) {
+    
+    YAML::Node definition = YAML::Load( GRAPH );
+    if (!lossy) { definition["processors"]["sink"].remove( "advanced" ); }
+    
+    graph::ProcessorGraph g( context );
+    g.Build( definition );
+    
+    for (auto & it : g.processors()) { it.second.second->PrepareProcessing(); }
+    
+    auto out = processor<TestSource>( g, "source" )->output_port_->slot(0);
+    auto in = processor<TestSink>( g, "sink" )->input_port_->slot(0);
+    EXPECT( in->lossy()==lossy );
+    
+    double next = 0;
+    ScalarData<double>* item;
+    
+    // a backlog of up to three quarters of the ring is read in order
+    publish( out, next, 12 );
+    EXPECT( in->RetrieveData( item ) );
+    EXPECT( item->data()==0 );
+    EXPECT( in->stats().dropped.load()==0 );
+    in->ReleaseData();
+    
+    if (!lossy) {
+        // a regular slot reads every item
+        for (int k=1; k<12; ++k) {
+            in->RetrieveData( item );
+            EXPECT( item->data()==k );
+            in->ReleaseData();
+        }
+        EXPECT( in->stats().dropped.load()==0 );
+        g.Destroy();
+        return;
+    }
+    
+    // a larger backlog is skipped, the newest item is retrieved
+    publish( out, next, 2 );
+    EXPECT( in->RetrieveData( item ) );
+    EXPECT( item->data()==13 );
+    EXPECT( in->stats().dropped.load()==12 );
+    in->ReleaseData();
+    
+    // the producer is not held back by the lossy slot, which catches up
+    // with the newest n items
+    publish( out, next, 40 );
+    std::vector<ScalarData<double>*> items;
+    EXPECT( in->RetrieveDataN( 4, items ) );
+    EXPECT( items.size()==4 );
+    EXPECT( items.front()->data()==50 && items.back()->data()==53 );
+    EXPECT( in->stats().dropped.load()==12 + 36 );
+    in->ReleaseData();
+    
+    // items that are overwritten while in use are reported on release
+    publish( out, next, 1 );
+    EXPECT( in->RetrieveData( item ) );
+    EXPECT( item->data()==54 );
+    publish( out, next, 17 );
+    in->ReleaseData();
+    EXPECT( in->stats().overwritten.load()==1 );
+    EXPECT( in->nitems_released()==1 + 1 + 4 + 1 );
+    
+    g.Destroy();
+}
+
+int main( int argc, char** argv ) {
+    
+    register_test_processors();
+    
+    std::map<std::string,std::string> uri;
+    GlobalContext context( false, uri );
+    
+    test_skip_overrun( context, true );
+    test_skip_overrun( context, false );
+    
+    return testing::check_result( "test_lossy" );
+}
@@ -0,0 +1,203 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+
+/* test_rebuild: incremental rebuild of a graph
+ * 
+ * When a graph is rebuilt, processors whose definition, connections and
+ * state links did not change are kept. Processors that share a ring buffer
+ * (multiple producers), a thread (fused processors) or linked states are
+ * tied: they are kept or rebuilt together.
+ */
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+
+#include "check.hpp"
+#include "testprocessors.hpp"
+#include "../src/graph/processorgraph.hpp"
+
+typedef std::set<std::string> Names;
+
+const char* CHAIN = R"(
+processors:
+    source: {class: TestSource}
+    filter: {class: TestFilter}
+    sink: {class: TestSink}
+connections:
+    - source.data=filter.data
+    - filter.data=sink.data
+)";
+
+const char* SHARED = R"(
+processors:
+    source1: {class: TestSource, advanced: {multi_producer: [data]}}
+    source2: {class: TestSource, advanced: {multi_producer: [data]}}
+    sink: {class: TestSink}
+    extra: {class: TestSource}
+    extrasink: {class: TestSink}
+connections:
+    - source1.data=sink.data.0
+    - source2.data=sink.data.0
+    - extra.data=extrasink.data
+)";
+
+YAML::Node modified( const char* definition, std::function<void(YAML::Node&)> modify ) {
+    
+    YAML::Node node = YAML::Load( definition );
+    modify( node );
+    return node;
+}
+
+void change( YAML::Node& node, std::string processor ) {
+    
+    node["processors"][processor]["options"]["tag"] = 1;
+}
+
+// build the graph, then check which processors would be kept for the new
+// definition and that a rebuild keeps those
+void check_rebuild( GlobalContext& context, const YAML::Node& before, const YAML::Node& after, const Names& expected ) {
+    
+    graph::ProcessorGraph g( context );
+    g.Build( before );
+    
+    StreamConnections connections;
+    for (auto & rule : after["connections"]) {
+        expandConnectionRule( parseConnectionRule( rule.as<std::string>() ), connections );
+    }
+    
+    Names retained = g.RetainedProcessors( after, connections );
+    EXPECT( retained==expected );
+    
+    std::map<std::string, ProcessorEngine*> engines;
+    for (auto & it : g.processors()) { engines[it.first] = it.second.second.get(); }
+    
+    g.Build( after );
+    EXPECT( g.state()==graph::GraphState::READY );
+    for (auto & name : expected) {
+        EXPECT( g.processors().at( name ).second.get()==engines[name] );
+    }
+    
+    g.Destroy();
+}
+
+void test_chain( GlobalContext& context ) {
+    
+    YAML::Node chain = YAML::Load( CHAIN );
+    
+    check_rebuild( context, chain, YAML::Load( CHAIN ), Names{ "source", "filter", "sink" } );
+    
+    // the order of the keys in a definition does not matter
+    check_rebuild( context,
+        modified( CHAIN, []( YAML::Node& n ) {
+            n["processors"]["source"] = YAML::Load( "{class: TestSource, options: {a: 1, b: [2, 3]}}" ); } ),
+        modified( CHAIN, []( YAML::Node& n ) {
+            n["processors"]["source"] = YAML::Load( "{options: {b: [2, 3], a: 1}, class: TestSource}" ); } ),
+        Names{ "source", "filter", "sink" } );
+    
+    check_rebuild( context, chain,
+        modified( CHAIN, []( YAML::Node& n ) { change( n, "sink" ); } ),
+        Names{ "source", "filter" } );
+    
+    check_rebuild( context, chain,
+        modified( CHAIN, []( YAML::Node& n ) { change( n, "source" ); } ),
+        Names{ "filter", "sink" } );
+    
+    // a new connection changes the processors at both ends
+    check_rebuild( context, chain,
+        modified( CHAIN, []( YAML::Node& n ) {
+            n["processors"]["monitor"]["class"] = "TestSink";
+            n["connections"].push_back( "filter.data=monitor.data" ); } ),
+        Names{ "source", "sink" } );
+    
+    // ring buffers of kept processors are not resized
+    check_rebuild( context, chain,
+        modified( CHAIN, []( YAML::Node& n ) { n["ring_sizing"]["max_stall"] = 50; } ),
+        Names{} );
+}
+
+void test_fused( GlobalContext& context ) {
+    
+    auto fuse = []( YAML::Node& n ) { n["processors"]["filter"]["advanced"]["fuse"] = true; };
+    YAML::Node fused = modified( CHAIN, fuse );
+    
+    check_rebuild( context, fused,
+        modified( CHAIN, [&fuse]( YAML::Node& n ) { fuse( n ); change( n, "sink" ); } ),
+        Names{ "source", "filter" } );
+    
+    // a fused processor runs in the thread of its upstream processor
+    check_rebuild( context, fused,
+        modified( CHAIN, [&fuse]( YAML::Node& n ) { fuse( n ); change( n, "source" ); } ),
+        Names{ "sink" } );
+}
+
+void test_shared_ring( GlobalContext& context ) {
+    
+    YAML::Node shared = YAML::Load( SHARED );
+    
+    check_rebuild( context, shared, YAML::Load( SHARED ),
+        Names{ "source1", "source2", "sink", "extra", "extrasink" } );
+    
+    // producers of a shared ring buffer and their consumer are rebuilt together
+    check_rebuild( context, shared,
+        modified( SHARED, []( YAML::Node& n ) { change( n, "source1" ); } ),
+        Names{ "extra", "extrasink" } );
+    
+    check_rebuild( context, shared,
+        modified( SHARED, []( YAML::Node& n ) { change( n, "sink" ); } ),
+        Names{ "extra", "extrasink" } );
+}
+
+void test_state_links( GlobalContext& context ) {
+    
+    auto link = []( YAML::Node& n ) {
+        YAML::Node states;
+        states.push_back( "filter.value" );
+        states.push_back( "sink.value" );
+        n["states"].push_back( states );
+    };
+    YAML::Node linked = modified( CHAIN, link );
+    
+    check_rebuild( context, linked, modified( CHAIN, link ), Names{ "source", "filter", "sink" } );
+    
+    // processors with linked states are rebuilt together
+    check_rebuild( context, linked,
+        modified( CHAIN, [&link]( YAML::Node& n ) { link( n ); change( n, "sink" ); } ),
+        Names{ "source" } );
+    
+    // removing the link changes both processors
+    check_rebuild( context, linked, YAML::Load( CHAIN ), Names{ "source" } );
+}
+
+int main( int argc, char** argv ) {
+    
+    register_test_processors();
+    
+    std::map<std::string,std::string> uri;
+    GlobalContext context( false, uri );
+    
+    test_chain( context );
+    test_fused( context );
+    test_shared_ring( context );
+    test_state_links( context );
+    
+    return testing::check_result( "test_rebuild" );
+}
@@ -0,0 +1,164 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+
+/* test_slotstats: behaviour of the retrieval statistics of input slots
+ * 
+ * Checks the bucketing, the quantile upper bounds, the maximum and reset of
+ * LogHistogram, including records that run concurrently with a reset.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "check.hpp"
+#include "../src/graph/slotstats.hpp"
+
+void test_empty() {
+    
+    LogHistogram histogram;
+    
+    EXPECT( histogram.count()==0 );
+    EXPECT( histogram.sum()==0 );
+    EXPECT( histogram.max()==0 );
+    EXPECT( histogram.quantile( 0.5 )==0 );
+    EXPECT( histogram.quantile( 0.999 )==0 );
+}
+
+void test_quantiles() {
+    
+    LogHistogram histogram;
+    
+    for (uint64_t value=1; value<=1000; ++value) {
+        histogram.Record( value );
+    }
+    
+    EXPECT( histogram.count()==1000 );
+    EXPECT( histogram.sum()==500500 );
+    EXPECT( histogram.max()==1000 );
+    
+    // a quantile is the upper bound of the bucket that holds it: values
+    // 256-511 fill the bucket of the median, values 512-1023 the bucket of p99
+    EXPECT( histogram.quantile( 0.5 )==511 );
+    EXPECT( histogram.quantile( 0.99 )==1023 );
+    EXPECT( histogram.quantile( 0.999 )==1023 );
+    
+    // the bound is never below the exact quantile, nor twice above it
+    for (double fraction : {0.1, 0.25, 0.5, 0.75, 0.9}) {
+        uint64_t exact = static_cast<uint64_t>( fraction * 1000 );
+        EXPECT( histogram.quantile( fraction ) >= exact );
+        EXPECT( histogram.quantile( fraction ) < 2*exact );
+    }
+    
+    // quantiles do not decrease with the fraction
+    uint64_t previous = 0;
+    for (double fraction=0; fraction<1; fraction+=0.01) {
+        EXPECT( histogram.quantile( fraction ) >= previous );
+        previous = histogram.quantile( fraction );
+    }
+}
+
+void test_bucket_edges() {
+    
+    LogHistogram zeros;
+    for (int k=0; k<10; ++k) { zeros.Record( 0 ); }
+    EXPECT( zeros.quantile( 0.5 )==0 );
+    EXPECT( zeros.max()==0 );
+    
+    // powers of two start a new bucket
+    LogHistogram edges;
+    edges.Record( 7 );
+    EXPECT( edges.quantile( 0.5 )==7 );
+    edges.Reset();
+    edges.Record( 8 );
+    EXPECT( edges.quantile( 0.5 )==15 );
+    
+    // the largest values go in the last bucket
+    LogHistogram large;
+    large.Record( UINT64_MAX );
+    EXPECT( large.quantile( 0.5 )==UINT64_MAX );
+    EXPECT( large.max()==UINT64_MAX );
+}
+
+void test_reset() {
+    
+    LogHistogram histogram;
+    for (uint64_t value=1; value<=100; ++value) { histogram.Record( value ); }
+    
+    histogram.Reset();
+    
+    EXPECT( histogram.count()==0 );
+    EXPECT( histogram.sum()==0 );
+    EXPECT( histogram.max()==0 );
+    EXPECT( histogram.quantile( 0.5 )==0 );
+    
+    histogram.Record( 3 );
+    EXPECT( histogram.count()==1 );
+    EXPECT( histogram.max()==3 );
+    EXPECT( histogram.quantile( 0.5 )==3 );
+}
+
+void test_concurrent_reset() {
+    
+    const uint64_t N = 1000000;
+    LogHistogram histogram;
+    std::atomic<bool> done( false );
+    
+    // the slot thread records while the command thread resets
+    std::thread writer( [&]() {
+        for (uint64_t k=0; k<N; ++k) { histogram.Record( 5 ); }
+        done.store( true );
+    } );
+    
+    while (!done.load()) {
+        histogram.Reset();
+        // a record that races with the reset is at most partially kept
+        EXPECT( histogram.count() <= N );
+        EXPECT( histogram.max() <= 5 );
+    }
+    writer.join();
+    
+    histogram.Reset();
+    EXPECT( histogram.count()==0 );
+    EXPECT( histogram.sum()==0 );
+    
+    // without resets, concurrent export sees a consistent total in the end
+    std::thread recorder( [&]() {
+        for (uint64_t k=0; k<N; ++k) { histogram.Record( 5 ); }
+    } );
+    while (histogram.count() < N) { histogram.quantile( 0.5 ); }
+    recorder.join();
+    
+    EXPECT( histogram.count()==N );
+    EXPECT( histogram.sum()==5*N );
+    EXPECT( histogram.max()==5 );
+    EXPECT( histogram.quantile( 0.5 )==7 );
+}
+
+int main( int argc, char** argv ) {
+    
+    test_empty();
+    test_quantiles();
+    test_bucket_edges();
+    test_reset();
+    test_concurrent_reset();
+    
+    return testing::check_result( "test_slotstats" );
+}
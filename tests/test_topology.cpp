@@ -0,0 +1,118 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+
+/* test_topology: order of processors in a graph
+ * 
+ * TopologicalOrder lists upstream processors before downstream ones (e.g.
+ * to step them in a single offline thread); ties and cycles are resolved
+ * by processor name, such that the order does not depend on the order of
+ * the graph definition.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "testprocessors.hpp"
+#include "../src/graph/processorgraph.hpp"
+
+std::vector<std::string> order( GlobalContext& context, const char* definition ) {
+    
+    graph::ProcessorGraph g( context );
+    g.Build( YAML::Load( definition ) );
+    
+    std::vector<std::string> names;
+    for (auto & engine : g.TopologicalOrder()) {
+        names.push_back( engine->name() );
+    }
+    
+    g.Destroy();
+    return names;
+}
+
+void test_chain( GlobalContext& context ) {
+    
+    // upstream first, regardless of name
+    auto names = order( context, R"(
+processors:
+    sink: {class: TestSink}
+    filter: {class: TestFilter}
+    source: {class: TestSource}
+connections:
+    - filter.data=sink.data
+    - source.data=filter.data
+)" );
+    
+    EXPECT( (names==std::vector<std::string>{ "source", "filter", "sink" }) );
+}
+
+void test_ties( GlobalContext& context ) {
+    
+    // independent processors are ordered by name, a processor follows all
+    // of its upstream processors
+    auto names = order( context, R"(
+processors:
+    source2: {class: TestSource}
+    source1: {class: TestSource}
+    fb: {class: TestFilter}
+    fa: {class: TestFilter}
+    sink: {class: TestSink}
+    idle: {class: TestSource}
+connections:
+    - source2.data=fb.data
+    - source1.data=fa.data
+    - fa.data=sink.data
+    - fb.data=sink.data
+)" );
+    
+    EXPECT( (names==std::vector<std::string>{ "idle", "source1", "fa", "source2", "fb", "sink" }) );
+}
+
+void test_cycle( GlobalContext& context ) {
+    
+    // a cycle is entered at the processor that comes first by name
+    auto names = order( context, R"(
+processors:
+    sink: {class: TestSink}
+    fq: {class: TestFilter}
+    fp: {class: TestFilter}
+connections:
+    - fp.data=fq.data
+    - fq.data=fp.data
+    - fq.data=sink.data
+)" );
+    
+    EXPECT( (names==std::vector<std::string>{ "fp", "fq", "sink" }) );
+}
+
+int main( int argc, char** argv ) {
+    
+    register_test_processors();
+    
+    std::map<std::string,std::string> uri;
+    GlobalContext context( false, uri );
+    
+    test_chain( context );
+    test_ties( context );
+    test_cycle( context );
+    
+    return testing::check_result( "test_topology" );
+}
@@ -0,0 +1,94 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+
+#ifndef TESTS_TESTPROCESSORS_HPP
+#define TESTS_TESTPROCESSORS_HPP
+
+/* minimal processors for the graph tests in this directory
+ * 
+ * TestSource: output port data <scalar double> (1-16 slots)
+ * TestFilter: input port data <scalar double> (1 slot), output port data
+ *             <scalar double> (1-16 slots), steppable (can be fused)
+ * TestSink: input port data <scalar double> (1-16 slots)
+ * 
+ * All processors expose a readable shared state "value", such that they
+ * can be linked. Processing returns right away: tests that need data in
+ * the ring buffers claim, publish and retrieve through the ports directly.
+ * Options are ignored, but take part in the processor definition (e.g. to
+ * force a processor to be rebuilt).
+ */
+
+#include "../src/graph/iprocessor.hpp"
+#include "../src/data/scalardata.hpp"
+
+typedef ScalarDataType<double> TestDataType;
+
+class TestSource : public IProcessor {
+public:
+    virtual void CreatePorts() override {
+        
+        output_port_ = create_output_port( "data", TestDataType(), PortOutPolicy( SlotRange(1,16), 16 ) );
+        create_readable_shared_state( "value", 0.0 );
+    }
+    
+    virtual void Process( ProcessingContext& context ) override {}
+    
+    PortOut<TestDataType>* output_port_;
+};
+
+class TestFilter : public IProcessor {
+public:
+    virtual void CreatePorts() override {
+        
+        input_port_ = create_input_port( "data", TestDataType(), PortInPolicy( SlotRange(1) ) );
+        output_port_ = create_output_port( "data", TestDataType(), PortOutPolicy( SlotRange(1,16), 16 ) );
+        create_readable_shared_state( "value", 0.0 );
+    }
+    
+    virtual void Process( ProcessingContext& context ) override {}
+    
+    virtual bool steppable() const override { return true; }
+    virtual StepResult ProcessStep( ProcessingContext& context ) override { return StepResult::DONE; }
+    
+    PortIn<TestDataType>* input_port_;
+    PortOut<TestDataType>* output_port_;
+};
+
+class TestSink : public IProcessor {
+public:
+    virtual void CreatePorts() override {
+        
+        input_port_ = create_input_port( "data", TestDataType(), PortInPolicy( SlotRange(1,16) ) );
+        create_readable_shared_state( "value", 0.0 );
+    }
+    
+    virtual void Process( ProcessingContext& context ) override {}
+    
+    PortIn<TestDataType>* input_port_;
+};
+
+inline void register_test_processors() {
+    
+    REGISTERPROCESSOR(TestSource)
+    REGISTERPROCESSOR(TestFilter)
+    REGISTERPROCESSOR(TestSink)
+}
+
+#endif // testprocessors.hpp
@@ -0,0 +1,378 @@
+// ---------------------------------------------------------------------
+// This file is part of falcon-server.
+// 
+// Copyright (C) 2015, 2016, 2017 Neuro-Electronics Research Flanders
+// 
+// Falcon-server is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// Falcon-server is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with falcon-server. If not, see <http://www.gnu.org/licenses/>.
+// ---------------------------------------------------------------------
+
+/* latencyharness: closed-loop latency benchmark of processor graphs
+ * 
+ * For every graph definition (by default all graphs in the intrinsic
+ * latency test folder) the harness:
+ * 1. rewrites the graph for a local run: NlxReader processors read from
+ *    the local UDP port and DigitalOutput processors drive a dummy device
+ * 2. builds and starts the graph on a running falcon server
+ * 3. runs nlxtestbench as a local stand-in for the Digilynx system; it
+ *    streams a square wave, such that every rising edge triggers the
+ *    execution of a digital output protocol
+ * 4. stops the graph and collects the source-to-output latency (latency
+ *    method of DigitalOutput) and the packet statistics (stats method of
+ *    NlxReader)
+ * 
+ * A summary table is written to standard output and, optionally, the full
+ * results are saved as YAML.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "cmdline/cmdline.h"
+#include "utilities/zmqutil.hpp"
+#include "yaml-cpp/yaml.h"
+
+static const double NLX_SAMPLING_RATE = 32000;
+
+class FalconClient {
+public:
+    FalconClient( std::string address, int timeout_ms ) :
+    context_(1), address_(address), timeout_ms_(timeout_ms) {
+        
+        connect();
+    }
+    
+    // sends a graph command, throws if falcon does not reply in time or
+    // replies with an error
+    zmq_frames graph( zmq_frames command ) {
+        
+        command.push_front( "graph" );
+        s_send_multi( *socket_, command );
+        
+        zmq_frames reply;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeout_ms_ );
+        while (!s_nonblocking_recv_multi( *socket_, reply )) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                // a REQ socket cannot send again before it received the reply,
+                // so start over with a fresh socket for the next command
+                connect();
+                throw std::runtime_error( "No reply from falcon to command \"" + command[1] + "\"." );
+            }
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        }
+        
+        if (!reply.empty() && reply[0]=="ERR") {
+            throw std::runtime_error( "Falcon could not execute command \"" + command[1] + "\": " +
+                (reply.size()>2 ? reply[2] : "unknown error") );
+        }
+        return reply;
+    }
+    
+protected:
+    void connect() {
+        
+        socket_.reset( new zmq::socket_t( context_, ZMQ_REQ ) );
+        int linger = 0;
+        socket_->setsockopt( ZMQ_LINGER, &linger, sizeof(linger) );
+        socket_->connect( address_.c_str() );
+    }
+    
+protected:
+    zmq::context_t context_;
+    std::unique_ptr<zmq::socket_t> socket_;
+    std::string address_;
+    int timeout_ms_;
+};
+
+struct HarnessConfig {
+    std::string testbench;
+    int udp_port;
+    double duration; // seconds
+    double event_rate; // Hz
+    double amplitude; // uV
+};
+
+namespace {
+
+std::vector<std::string> list_graphs( std::string folder ) {
+    
+    std::vector<std::string> files;
+    
+    DIR* dir = opendir( folder.c_str() );
+    if (dir==nullptr) {
+        throw std::runtime_error( "Cannot open graph folder " + folder + "." );
+    }
+    
+    struct dirent* entry;
+    while ((entry = readdir( dir ))!=nullptr) {
+        std::string name = entry->d_name;
+        if (name.size()>5 && name.compare( name.size()-5, 5, ".yaml" )==0) {
+            files.push_back( folder + "/" + name );
+        }
+    }
+    closedir( dir );
+    
+    std::sort( files.begin(), files.end() );
+    return files;
+}
+
+// point readers at the local test bench and replace digital output hardware;
+// returns the names of the reader and output processors
+void rewrite_graph( YAML::Node graph, const HarnessConfig& config,
+    std::vector<std::string>& readers, std::vector<std::string>& outputs ) {
+    
+    for (auto it : graph["processors"]) {
+        std::string cls = it.second["class"].as<std::string>( "" );
+        YAML::Node options = it.second["options"];
+        if (cls=="NlxReader") {
+            options["address"] = "127.0.0.1";
+            options["port"] = config.udp_port;
+            options["npackets"] = 0;
+            readers.push_back( it.first.as<std::string>() );
+        } else if (cls=="DigitalOutput") {
+            YAML::Node device;
+            device["type"] = "dummy";
+            options["device"] = device;
+            options["lockout_period"] = 0;
+            options["enable_saving"] = false;
+            outputs.push_back( it.first.as<std::string>() );
+        }
+    }
+}
+
+std::string write_testbench_config( const HarnessConfig& config, uint64_t npackets ) {
+    
+    YAML::Node node;
+    node["network"]["ip"] = "127.0.0.1";
+    node["network"]["port"] = config.udp_port;
+    node["stream"]["rate"] = NLX_SAMPLING_RATE;
+    node["stream"]["npackets"] = npackets;
+    
+    YAML::Node source;
+    source["class"] = "square";
+    source["options"]["amplitude"] = config.amplitude;
+    source["options"]["frequency"] = config.event_rate;
+    source["options"]["duty_cycle"] = 0.5;
+    source["options"]["sampling_rate"] = NLX_SAMPLING_RATE;
+    node["sources"].push_back( source );
+    
+    char path[] = "/tmp/latencyharness_XXXXXX";
+    int fd = mkstemp( path );
+    if (fd<0) { throw std::runtime_error( "Cannot create test bench configuration file." ); }
+    close( fd );
+    
+    std::ofstream out( path );
+    YAML::Emitter emitter;
+    emitter << node;
+    out << emitter.c_str() << std::endl;
+    
+    return path;
+}
+
+// streams npackets with the test bench and waits until it is done
+void run_testbench( const HarnessConfig& config, uint64_t npackets ) {
+    
+    std::string config_file = write_testbench_config( config, npackets );
+    
+    pid_t pid = fork();
+    if (pid<0) {
+        throw std::runtime_error( "Cannot start test bench." );
+    } else if (pid==0) {
+        // keep the test bench away from the terminal of the harness
+        freopen( "/dev/null", "r", stdin );
+        freopen( "/dev/null", "w", stdout );
+        execlp( config.testbench.c_str(), config.testbench.c_str(),
+            "-c", config_file.c_str(), "-a", "0", (char*) nullptr );
+        _exit( EXIT_FAILURE );
+    }
+    
+    // the test bench keeps running after streaming all packets
+    std::this_thread::sleep_for( std::chrono::duration<double>( npackets / NLX_SAMPLING_RATE + 1.0 ) );
+    kill( pid, SIGINT );
+    
+    int status;
+    waitpid( pid, &status, 0 );
+    unlink( config_file.c_str() );
+    
+    if (WIFEXITED(status) && WEXITSTATUS(status)!=EXIT_SUCCESS) {
+        throw std::runtime_error( "Test bench " + config.testbench + " failed." );
+    }
+}
+
+YAML::Node run_graph( FalconClient& falcon, std::string file, const HarnessConfig& config ) {
+    
+    YAML::Node graph = YAML::LoadFile( file );
+    std::vector<std::string> readers, outputs;
+    rewrite_graph( graph, config, readers, outputs );
+    
+    if (outputs.empty()) {
+        throw std::runtime_error( "Graph has no DigitalOutput processor." );
+    }
+    
+    YAML::Emitter emitter;
+    emitter << graph;
+    
+    uint64_t npackets = config.duration * NLX_SAMPLING_RATE;
+    
+    falcon.graph( { "build", emitter.c_str() } );
+    
+    YAML::Node result;
+    try {
+        falcon.graph( { "start" } );
+        
+        // give the readers time to bind their sockets
+        std::this_thread::sleep_for( std::chrono::seconds( 2 ) );
+        run_testbench( config, npackets );
+        
+        falcon.graph( { "stop" } );
+        
+        for (auto & name : outputs) {
+            YAML::Node method;
+            method[name]["latency"] = YAML::Node( YAML::NodeType::Map );
+            YAML::Emitter out;
+            out << method;
+            result["latency_ns"][name] = YAML::Load( falcon.graph( { "apply", out.c_str() } )[0] )[name]["latency"];
+        }
+        for (auto & name : readers) {
+            YAML::Node method;
+            method[name]["stats"] = YAML::Node( YAML::NodeType::Map );
+            YAML::Emitter out;
+            out << method;
+            YAML::Node stats = YAML::Load( falcon.graph( { "apply", out.c_str() } )[0] )[name]["stats"];
+            stats["sent"] = npackets;
+            result["packets"][name] = stats;
+        }
+    } catch (...) {
+        // best effort clean up (the graph may not have started), such that
+        // the next graph can be built; the original error is reported
+        try { falcon.graph( { "stop" } ); } catch (...) {}
+        try { falcon.graph( { "destroy" } ); } catch (...) {}
+        throw;
+    }
+    
+    falcon.graph( { "destroy" } );
+    
+    return result;
+}
+
+void print_summary( const YAML::Node& results ) {
+    
+    std::cout << std::left << std::setw(24) << "graph" << std::right
+        << std::setw(8) << "events"
+        << std::setw(10) << "p50(us)" << std::setw(10) << "p99(us)"
+        << std::setw(11) << "p99.9(us)" << std::setw(10) << "max(us)"
+        << std::setw(10) << "lost(%)" << std::endl;
+    
+    for (auto it : results) {
+        std::string name = it.first.as<std::string>();
+        const YAML::Node& result = it.second;
+        
+        std::cout << std::left << std::setw(24) << name << std::right;
+        
+        if (result["error"]) {
+            std::cout << "  " << result["error"].as<std::string>() << std::endl;
+            continue;
+        }
+        
+        // worst output and worst reader of the graph
+        YAML::Node latency;
+        for (auto output : result["latency_ns"]) {
+            if (!latency || output.second["p99"].as<int64_t>( 0 ) > latency["p99"].as<int64_t>( 0 )) {
+                latency = output.second;
+            }
+        }
+        double lost = 0;
+        for (auto reader : result["packets"]) {
+            double sent = reader.second["sent"].as<double>();
+            double received = reader.second["received"].as<double>( 0 );
+            lost = std::max( lost, sent>0 ? std::max( 0.0, 100.0*(sent-received)/sent ) : 0.0 );
+        }
+        
+        auto us = [&latency]( std::string key ) { return latency[key].as<double>( 0 ) / 1000.0; };
+        
+        std::cout << std::fixed << std::setprecision(1)
+            << std::setw(8) << latency["n"].as<uint64_t>( 0 )
+            << std::setw(10) << us( "p50" ) << std::setw(10) << us( "p99" )
+            << std::setw(11) << us( "p99.9" ) << std::setw(10) << us( "max" )
+            << std::setprecision(3) << std::setw(10) << lost << std::endl;
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    
+    cmdline::parser parser;
+    
+    parser.add<std::string>("server", 's', "address of the falcon server", false, "tcp://localhost:5555" );
+    parser.add<std::string>("graphs", 'g', "folder with graph definitions (ignored if graph files are given)", false, "tests/graphs/intrinsic_latency" );
+    parser.add<std::string>("testbench", 't', "nlxtestbench executable", false, "nlxtestbench" );
+    parser.add<int>("udp_port", 'p', "local UDP port for the test bench stream", false, 5000 );
+    parser.add<double>("duration", 'd', "duration of each run (seconds)", false, 30 );
+    parser.add<double>("event_rate", 'e', "rate of the square wave that triggers the outputs (Hz)", false, 10 );
+    parser.add<double>("amplitude", 'a', "amplitude of the square wave (uV)", false, 500 );
+    parser.add<std::string>("output", 'o', "save all results to this YAML file", false, "" );
+    parser.footer("[graph_file ...]");
+    
+    parser.parse_check(argc, argv);
+    
+    HarnessConfig config{ parser.get<std::string>("testbench"), parser.get<int>("udp_port"),
+        parser.get<double>("duration"), parser.get<double>("event_rate"), parser.get<double>("amplitude") };
+    
+    std::vector<std::string> files = parser.rest();
+    try {
+        if (files.empty()) { files = list_graphs( parser.get<std::string>("graphs") ); }
+    } catch (std::exception & e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    
+    FalconClient falcon( parser.get<std::string>("server"), 30000 );
+    
+    YAML::Node results( YAML::NodeType::Map );
+    
+    for (auto & file : files) {
+        std::string name = file.substr( file.find_last_of( '/' ) + 1 );
+        std::cerr << "Running " << name << " for " << config.duration << " seconds." << std::endl;
+        try {
+            results[name] = run_graph( falcon, file, config );
+        } catch (std::exception & e) {
+            std::cerr << name << ": " << e.what() << std::endl;
+            results[name]["error"] = e.what();
+        }
+    }
+    
+    print_summary( results );
+    
+    if (!parser.get<std::string>("output").empty()) {
+        std::ofstream out( parser.get<std::string>("output") );
+        YAML::Emitter emitter;
+        emitter << results;
+        out << emitter.c_str() << std::endl;
+    }
+    
+    return EXIT_SUCCESS;
+}